@@ -27,6 +27,8 @@ extern "C"
     MaaBool MAA_FRAMEWORK_API MaaClearImage(MaaImageBufferHandle handle);
 
     typedef void* MaaImageRawData;
+    // 返回的是 buffer 内部的数据，不要通过它修改图像；要改的话先 MaaSetImageRawData 到自己的 buffer 里
+    // 特别是自定义识别器拿到的 image 和框架共用同一块内存，改了会影响其他识别和之后的截图
     MaaImageRawData MAA_FRAMEWORK_API MaaGetImageRawData(MaaImageBufferHandle handle);
     int32_t MAA_FRAMEWORK_API MaaGetImageWidth(MaaImageBufferHandle handle);
     int32_t MAA_FRAMEWORK_API MaaGetImageHeight(MaaImageBufferHandle handle);
@@ -63,6 +65,21 @@ extern "C"
                                                                  MaaAdbControllerType type, MaaStringView config,
                                                                  MaaControllerCallback callback,
                                                                  MaaCallbackTransparentArg callback_arg);
+    // display 为空时用 $DISPLAY；config 见 X11Controller.h，为空时截整个 root window。需要 WITH_X11 构建
+    MaaControllerHandle MAA_FRAMEWORK_API MaaX11ControllerCreate(MaaStringView display, MaaStringView config,
+                                                                 MaaControllerCallback callback,
+                                                                 MaaCallbackTransparentArg callback_arg);
+    // 回放 MaaCtrlOption_Recording 录下的会话，不需要设备。config 见 ReplayController.h
+    MaaControllerHandle MAA_FRAMEWORK_API MaaReplayControllerCreate(MaaStringView config,
+                                                                    MaaControllerCallback callback,
+                                                                    MaaCallbackTransparentArg callback_arg);
+    // 从视频文件或图片目录取帧，动作都不执行，用来离线跑识别。config 见 FileController.h，可以为空
+    MaaControllerHandle MAA_FRAMEWORK_API MaaVideoControllerCreate(MaaStringView path, MaaStringView config,
+                                                                   MaaControllerCallback callback,
+                                                                   MaaCallbackTransparentArg callback_arg);
+    MaaControllerHandle MAA_FRAMEWORK_API MaaImageDirControllerCreate(MaaStringView dir, MaaStringView config,
+                                                                      MaaControllerCallback callback,
+                                                                      MaaCallbackTransparentArg callback_arg);
     MaaControllerHandle MAA_FRAMEWORK_API MaaCustomControllerCreate(MaaCustomControllerHandle handle,
                                                                     MaaControllerCallback callback,
                                                                     MaaCallbackTransparentArg callback_arg);
@@ -85,14 +102,31 @@ extern "C"
     MaaCtrlId MAA_FRAMEWORK_API MaaControllerPostTouchMove(MaaControllerHandle ctrl, int32_t contact, int32_t x,
                                                            int32_t y, int32_t pressure);
     MaaCtrlId MAA_FRAMEWORK_API MaaControllerPostTouchUp(MaaControllerHandle ctrl, int32_t contact);
+    // 一整段多点触控，events 为 json 数组，按 time（毫秒，相对手势开始）执行：
+    // [{ "type": "down", "contact": 0, "x": 100, "y": 200, "pressure": 0, "time": 0 }, { "type": "move", ... }, ...]
+    // "type" 为 down / move / up，up 不需要坐标；minitouch / maatouch 会整段编码后一次下发
+    MaaCtrlId MAA_FRAMEWORK_API MaaControllerPostGesture(MaaControllerHandle ctrl, MaaStringView events);
 
     MaaCtrlId MAA_FRAMEWORK_API MaaControllerPostScreencap(MaaControllerHandle ctrl);
 
     MaaStatus MAA_FRAMEWORK_API MaaControllerStatus(MaaControllerHandle ctrl, MaaCtrlId id);
     MaaStatus MAA_FRAMEWORK_API MaaControllerWait(MaaControllerHandle ctrl, MaaCtrlId id);
+    // 打开 MaaCtrlOption_ParallelLanes 后截图、输入、启停应用在各自的队列里执行，互相不等
+    // 需要前面的动作都做完再继续的，用这个当屏障
+    MaaBool MAA_FRAMEWORK_API MaaControllerWaitAll(MaaControllerHandle ctrl);
     MaaBool MAA_FRAMEWORK_API MaaControllerConnected(MaaControllerHandle ctrl);
 
     MaaBool MAA_FRAMEWORK_API MaaControllerGetImage(MaaControllerHandle ctrl, /* out */ MaaImageBufferHandle buffer);
+    // MaaControllerGetImage 那张图相对上一张截图变了的区域，json 数组 [[x, y, w, h], ...]
+    // 截图方式不知道哪里变了（目前只有 TileStream 知道）时返回 false，当作整张都变了
+    MaaBool MAA_FRAMEWORK_API MaaControllerGetChangedRegions(MaaControllerHandle ctrl,
+                                                             /* out */ MaaStringBufferHandle buffer);
+    // 自动选择截图方式时（adb 的 FastestWay）当前用的方式和各方式的统计，json:
+    // { "method": "MinicapStream", "stats": [ { "method", "success", "failure", "consecutive_failure",
+    //   "median", "p90", "baseline" }, ... ] }，耗时单位毫秒，没有数据时为 -1
+    // 控制器不会自动选择截图方式时返回 false
+    MaaBool MAA_FRAMEWORK_API MaaControllerGetScreencapStats(MaaControllerHandle ctrl,
+                                                             /* out */ MaaStringBufferHandle buffer);
     MaaBool MAA_FRAMEWORK_API MaaControllerGetUUID(MaaControllerHandle ctrl, /* out */ MaaStringBufferHandle buffer);
 
     /* Instance */
@@ -106,6 +140,7 @@ extern "C"
     MaaBool MAA_FRAMEWORK_API MaaBindController(MaaInstanceHandle inst, MaaControllerHandle ctrl);
     MaaBool MAA_FRAMEWORK_API MaaInited(MaaInstanceHandle inst);
 
+    // analyze 收到的 image 只读，不拷贝，直接是当前截图（见 MaaGetImageRawData）
     MaaBool MAA_FRAMEWORK_API MaaRegisterCustomRecognizer(MaaInstanceHandle inst, MaaStringView name,
                                                           MaaCustomRecognizerHandle recognizer);
     MaaBool MAA_FRAMEWORK_API MaaUnregisterCustomRecognizer(MaaInstanceHandle inst, MaaStringView name);
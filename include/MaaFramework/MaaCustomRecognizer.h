@@ -10,6 +10,7 @@ extern "C"
 
     struct MaaCustomRecognizerAPI
     {
+        // image 和框架共用同一块内存，只能读；要在上面画东西的请先复制一份
         MaaBool (*analyze)(MaaSyncContextHandle sync_context, const MaaImageBufferHandle image, MaaStringView task_name,
                            MaaStringView custom_recognition_param,
                            /*out*/ MaaRectHandle out_box,
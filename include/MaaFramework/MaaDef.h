@@ -80,6 +80,22 @@ enum MaaCtrlOptionEnum
     // For StopApp
     // value: string, eg: "com.hypergryph.arknights"; val_size: string length
     MaaCtrlOption_DefaultAppPackage = 4,
+
+    // Keep capturing in background, tasks take the freshest frame instead of waiting for a new screencap.
+    // value: MaaBool, eg: 1; val_size: sizeof(MaaBool)
+    MaaCtrlOption_CaptureAhead = 5,
+
+    // Record every screenshot and action into a session directory, which can be replayed by MaaReplayControllerCreate.
+    // Empty string stops recording.
+    // value: string, eg: "./debug/session"; val_size: string length
+    MaaCtrlOption_Recording = 6,
+
+    // Run screencap, input and app management on separate queues, so a long swipe does not block screencaps.
+    // Actions on different queues are no longer ordered; use MaaControllerWait / MaaControllerWaitAll as barriers.
+    // Only controllers that can be called concurrently support it (currently the adb controller).
+    // Set it before posting actions.
+    // value: MaaBool, eg: 1; val_size: sizeof(MaaBool)
+    MaaCtrlOption_ParallelLanes = 7,
 };
 
 typedef MaaOption MaaInstOption;
@@ -98,16 +114,19 @@ enum MaaAdbControllerTypeEnum
     MaaAdbControllerType_Touch_Adb = 1,
     MaaAdbControllerType_Touch_MiniTouch = 2,
     MaaAdbControllerType_Touch_MaaTouch = 3,
+    MaaAdbControllerType_Touch_Scrcpy = 4,
     MaaAdbControllerType_Touch_Mask = 0xFF,
 
     MaaAdbControllerType_Key_Adb = 1 << 8,
     MaaAdbControllerType_Key_MaaTouch = 2 << 8,
+    MaaAdbControllerType_Key_Scrcpy = 3 << 8,
     MaaAdbControllerType_Key_Mask = 0xFF00,
 
     MaaAdbControllerType_Input_Preset_Adb = MaaAdbControllerType_Touch_Adb | MaaAdbControllerType_Key_Adb,
     MaaAdbControllerType_Input_Preset_Minitouch = MaaAdbControllerType_Touch_MiniTouch | MaaAdbControllerType_Key_Adb,
     MaaAdbControllerType_Input_Preset_Maatouch =
         MaaAdbControllerType_Touch_MaaTouch | MaaAdbControllerType_Key_MaaTouch,
+    MaaAdbControllerType_Input_Preset_Scrcpy = MaaAdbControllerType_Touch_Scrcpy | MaaAdbControllerType_Key_Scrcpy,
 
     MaaAdbControllerType_Screencap_FastestWay = 1 << 16,
     MaaAdbControllerType_Screencap_RawByNetcat = 2 << 16,
@@ -116,6 +135,8 @@ enum MaaAdbControllerTypeEnum
     MaaAdbControllerType_Screencap_EncodeToFile = 5 << 16,
     MaaAdbControllerType_Screencap_MinicapDirect = 6 << 16,
     MaaAdbControllerType_Screencap_MinicapStream = 7 << 16,
+    MaaAdbControllerType_Screencap_TileStream = 8 << 16,
+    MaaAdbControllerType_Screencap_Scrcpy = 9 << 16,
     MaaAdbControllerType_Screencap_Mask = 0xFF0000,
 };
 
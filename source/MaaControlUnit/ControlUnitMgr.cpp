@@ -8,6 +8,7 @@
 #include "General/DeviceList.h"
 #include "Input/MaatouchInput.h"
 #include "Input/MinitouchInput.h"
+#include "Input/ScrcpyInput.h"
 #include "Input/TapInput.h"
 #include "Platform/PlatformFactory.h"
 #include "Screencap/Encode.h"
@@ -17,6 +18,8 @@
 #include "Screencap/Minicap/MinicapStream.h"
 #include "Screencap/RawByNetcat.h"
 #include "Screencap/RawWithGzip.h"
+#include "Screencap/Scrcpy.h"
+#include "Screencap/TileStream/TileStream.h"
 #include "Utils/Logger.h"
 
 #pragma message("MAA_VERSION: " MAA_VERSION)
@@ -126,6 +129,21 @@ std::shared_ptr<ControlUnitAPI> create_adb_controller_unit(MaaStringView adb_pat
     auto screencap_type = type & MaaAdbControllerType_Screencap_Mask;
 
     std::shared_ptr<MaatouchInput> maatouch_unit = nullptr;
+    // 截图和输入都用 scrcpy 时共用一个 server
+    std::shared_ptr<ScrcpyServer> scrcpy_server = nullptr;
+    std::shared_ptr<ScrcpyInput> scrcpy_input = nullptr;
+    auto get_scrcpy_server = [&]() {
+        if (!scrcpy_server) {
+            scrcpy_server = std::make_shared<ScrcpyServer>();
+        }
+        return scrcpy_server;
+    };
+    auto get_scrcpy_input = [&]() {
+        if (!scrcpy_input) {
+            scrcpy_input = std::make_shared<ScrcpyInput>(get_scrcpy_server());
+        }
+        return scrcpy_input;
+    };
 
     switch (touch_type) {
     case MaaAdbControllerType_Touch_Adb:
@@ -143,6 +161,10 @@ std::shared_ptr<ControlUnitAPI> create_adb_controller_unit(MaaStringView adb_pat
         }
         touch_unit = maatouch_unit;
         break;
+    case MaaAdbControllerType_Touch_Scrcpy:
+        LogInfo << "touch_type: ScrcpyInput";
+        touch_unit = get_scrcpy_input();
+        break;
     default:
         LogError << "Unknown touch input type" << VAR(touch_type);
         return nullptr;
@@ -160,6 +182,10 @@ std::shared_ptr<ControlUnitAPI> create_adb_controller_unit(MaaStringView adb_pat
         }
         key_unit = maatouch_unit;
         break;
+    case MaaAdbControllerType_Key_Scrcpy:
+        LogInfo << "key_type: ScrcpyInput";
+        key_unit = get_scrcpy_input();
+        break;
     default:
         LogError << "Unknown key input type" << VAR(key_type);
         return nullptr;
@@ -194,6 +220,14 @@ std::shared_ptr<ControlUnitAPI> create_adb_controller_unit(MaaStringView adb_pat
         LogInfo << "screencap_type: MinicapStream";
         screencap_unit = std::make_shared<MinicapStream>();
         break;
+    case MaaAdbControllerType_Screencap_TileStream:
+        LogInfo << "screencap_type: TileStream";
+        screencap_unit = std::make_shared<ScreencapTileStream>();
+        break;
+    case MaaAdbControllerType_Screencap_Scrcpy:
+        LogInfo << "screencap_type: Scrcpy";
+        screencap_unit = std::make_shared<ScreencapScrcpy>(get_scrcpy_server());
+        break;
     default:
         LogError << "Unknown screencap type" << VAR(screencap_type);
         return nullptr;
@@ -356,6 +390,10 @@ std::shared_ptr<TouchInputAPI> create_adb_touch_input(MaaStringView adb_path, Ma
         LogInfo << "touch_type: MaatouchInput";
         touch_unit = std::make_shared<MaatouchInput>();
         break;
+    case MaaAdbControllerType_Touch_Scrcpy:
+        LogInfo << "touch_type: ScrcpyInput";
+        touch_unit = std::make_shared<ScrcpyInput>(std::make_shared<ScrcpyServer>());
+        break;
     default:
         LogError << "Unknown touch input type" << VAR(type);
         return nullptr;
@@ -400,6 +438,10 @@ std::shared_ptr<KeyInputAPI> create_adb_key_input(MaaStringView adb_path, MaaStr
         LogInfo << "key_type: MaatouchInput";
         key_unit = std::make_shared<MaatouchInput>();
         break;
+    case MaaAdbControllerType_Key_Scrcpy:
+        LogInfo << "key_type: ScrcpyInput";
+        key_unit = std::make_shared<ScrcpyInput>(std::make_shared<ScrcpyServer>());
+        break;
     default:
         LogError << "Unknown key input type" << VAR(type);
         return nullptr;
@@ -464,6 +506,14 @@ std::shared_ptr<ScreencapAPI> create_adb_screencap(MaaStringView adb_path, MaaSt
         LogInfo << "screencap_type: MinicapStream";
         screencap_unit = std::make_shared<MinicapStream>();
         break;
+    case MaaAdbControllerType_Screencap_TileStream:
+        LogInfo << "screencap_type: TileStream";
+        screencap_unit = std::make_shared<ScreencapTileStream>();
+        break;
+    case MaaAdbControllerType_Screencap_Scrcpy:
+        LogInfo << "screencap_type: Scrcpy";
+        screencap_unit = std::make_shared<ScreencapScrcpy>(std::make_shared<ScrcpyServer>());
+        break;
     default:
         LogError << "Unknown screencap type" << VAR(type);
         return nullptr;
@@ -3,6 +3,7 @@
 #include "UnitBase.h"
 
 #include "Invoke/InvokeApp.h"
+#include "MtouchWriter.h"
 
 MAA_CTRL_UNIT_NS_BEGIN
 
@@ -46,6 +47,7 @@ public: // from TouchInputAPI
     virtual bool touch_down(int contact, int x, int y, int pressure) override;
     virtual bool touch_move(int contact, int x, int y, int pressure) override;
     virtual bool touch_up(int contact) override;
+    virtual bool gesture(const std::vector<TouchEvent>& events) override;
 
 public: // from KeyInputAPI
     virtual bool press_key(int key) override;
@@ -57,8 +59,12 @@ private:
         return std::make_pair(static_cast<int>(round(x * xscale_)), static_cast<int>(round(y * yscale_)));
     }
 
+    MtouchWriter::ToTouch to_touch();
+
     std::shared_ptr<InvokeApp> invoke_app_ = std::make_shared<InvokeApp>();
     std::shared_ptr<IOHandler> shell_handler_ = nullptr;
+    // 所有写入都经过它，保证顺序
+    std::shared_ptr<MtouchWriter> writer_ = nullptr;
 
     std::string root_;
     std::string package_name_;
@@ -100,10 +100,13 @@ bool MinitouchInput::init(int swidth, int sheight, int orientation)
     };
 
     constexpr std::string_view kMinitouchArgs = "-i";
+    // 旧的写入线程还拿着旧的 shell，先停掉
+    writer_ = nullptr;
     shell_handler_ = invoke_app_->invoke_bin(std::string(kMinitouchArgs));
     if (!shell_handler_) {
         return false;
     }
+    writer_ = std::make_shared<MtouchWriter>(shell_handler_);
 
     std::string prev;
     std::string info;
@@ -168,7 +171,7 @@ void MinitouchInput::set_wh(int swidth, int sheight, int orientation)
 
 bool MinitouchInput::click(int x, int y)
 {
-    if (!shell_handler_) {
+    if (!writer_) {
         LogError << "shell handler not ready";
         return false;
     }
@@ -179,24 +182,18 @@ bool MinitouchInput::click(int x, int y)
         y = std::clamp(y, 0, screen_height_ - 1);
     }
 
-    auto [touch_x, touch_y] = screen_to_touch(x, y);
-
-    LogInfo << VAR(x) << VAR(y) << VAR(touch_x) << VAR(touch_y);
-
-    bool ret = shell_handler_->write(MAA_FMT::format("d {} {} {} {}\nc\n", 0, touch_x, touch_y, press_)) &&
-               shell_handler_->write(MAA_FMT::format("u {}\nc\n", 0));
-
-    if (!ret) {
-        LogError << "failed to write";
-        return false;
-    }
+    LogInfo << VAR(x) << VAR(y);
 
-    return ret;
+    return gesture({
+        { .type = TouchEvent::Type::Down, .contact = 0, .x = x, .y = y, .pressure = press_ },
+        { .type = TouchEvent::Type::Up, .contact = 0 },
+    });
 }
 
 bool MinitouchInput::swipe(int x1, int y1, int x2, int y2, int duration)
 {
-    if (!shell_handler_) {
+    if (!writer_) {
+        LogError << "shell handler not ready";
         return false;
     }
 
@@ -213,113 +210,94 @@ bool MinitouchInput::swipe(int x1, int y1, int x2, int y2, int duration)
         duration = 500;
     }
 
-    auto [touch_x1, touch_y1] = screen_to_touch(x1, y1);
-    auto [touch_x2, touch_y2] = screen_to_touch(x2, y2);
+    LogInfo << VAR(x1) << VAR(y1) << VAR(x2) << VAR(y2) << VAR(duration);
 
-    LogInfo << VAR(x1) << VAR(y1) << VAR(touch_x1) << VAR(touch_y1) << VAR(x2) << VAR(y2) << VAR(touch_x2)
-            << VAR(touch_y2) << VAR(duration);
+    constexpr int kInterval = 10; // ms
 
-    auto start = std::chrono::steady_clock::now();
-    auto now = start;
-    bool ret = true;
-    ret &= shell_handler_->write(MAA_FMT::format("d {} {} {} {}\nc\n", 0, touch_x1, touch_y1, press_));
-    if (!ret) {
-        LogError << "write error";
-        return false;
-    }
-
-    constexpr double kInterval = 10; // ms
-    const double steps = duration / kInterval;
-    const double x_step_len = (x2 - x1) / steps;
-    const double y_step_len = (y2 - y1) / steps;
-    const std::chrono::milliseconds delay(static_cast<int>(kInterval));
-
-    for (int i = 0; i < steps; ++i) {
-        auto [tx, ty] = screen_to_touch(x1 + steps * x_step_len, y1 + steps * y_step_len);
-        std::this_thread::sleep_until(now + delay);
-        now = std::chrono::steady_clock::now();
-
-        ret &= shell_handler_->write(MAA_FMT::format("m {} {} {} {}\nc\n", 0, tx, ty, press_));
-        if (!ret) {
-            LogWarn << "write error";
-        }
-    }
-
-    std::this_thread::sleep_until(now + delay);
-    now = std::chrono::steady_clock::now();
-    ret &= shell_handler_->write(MAA_FMT::format("m {} {} {} {}\nc\n", 0, touch_x2, touch_y2, press_));
-
-    std::this_thread::sleep_until(now + delay);
-    now = std::chrono::steady_clock::now();
-    ret &= shell_handler_->write(MAA_FMT::format("u {}\nc\n", 0));
+    std::vector<TouchEvent> events;
+    auto add = [&](TouchEvent::Type type, int x, int y, int time) {
+        events.emplace_back(
+            TouchEvent { .type = type, .contact = 0, .x = x, .y = y, .pressure = press_, .time = time });
+    };
 
-    if (!ret) {
-        LogError << "failed to write";
-        return false;
+    add(TouchEvent::Type::Down, x1, y1, 0);
+    for (int time = kInterval; time < duration; time += kInterval) {
+        double progress = static_cast<double>(time) / duration;
+        add(TouchEvent::Type::Move, static_cast<int>(std::round(x1 + (x2 - x1) * progress)),
+            static_cast<int>(std::round(y1 + (y2 - y1) * progress)), time);
     }
+    add(TouchEvent::Type::Move, x2, y2, duration);
+    add(TouchEvent::Type::Up, x2, y2, duration + kInterval);
 
-    return ret;
+    return gesture(events);
 }
 
 bool MinitouchInput::touch_down(int contact, int x, int y, int pressure)
 {
-    if (!shell_handler_) {
+    if (!writer_) {
         LogError << "shell handler not ready";
         return false;
     }
 
-    auto [touch_x, touch_y] = screen_to_touch(x, y);
+    LogInfo << VAR(contact) << VAR(x) << VAR(y) << VAR(pressure);
 
-    LogInfo << VAR(contact) << VAR(x) << VAR(y) << VAR(touch_x) << VAR(touch_y);
-
-    bool ret = shell_handler_->write(MAA_FMT::format("d {} {} {} {}\nc\n", contact, touch_x, touch_y, pressure));
-
-    if (!ret) {
-        LogError << "failed to write";
-        return false;
-    }
-
-    return ret;
+    TouchEvent event { .type = TouchEvent::Type::Down, .contact = contact, .x = x, .y = y, .pressure = pressure };
+    return writer_->write(MtouchWriter::encode({ event }, to_touch()));
 }
 
 bool MinitouchInput::touch_move(int contact, int x, int y, int pressure)
 {
-    if (!shell_handler_) {
+    if (!writer_) {
         LogError << "shell handler not ready";
         return false;
     }
 
-    auto [touch_x, touch_y] = screen_to_touch(x, y);
-
-    LogInfo << VAR(contact) << VAR(x) << VAR(y) << VAR(touch_x) << VAR(touch_y);
-
-    bool ret = shell_handler_->write(MAA_FMT::format("m {} {} {} {}\nc\n", contact, touch_x, touch_y, pressure));
+    LogDebug << VAR(contact) << VAR(x) << VAR(y) << VAR(pressure);
 
-    if (!ret) {
+    // 不等写出，还没写出去的会被下一个 move 合并掉
+    TouchEvent event { .type = TouchEvent::Type::Move, .contact = contact, .x = x, .y = y, .pressure = pressure };
+    auto chunks = MtouchWriter::encode({ event }, to_touch());
+    if (!writer_->post_move(contact, std::move(chunks.front().data))) {
         LogError << "failed to write";
         return false;
     }
-
-    return ret;
+    return true;
 }
 
 bool MinitouchInput::touch_up(int contact)
 {
-    if (!shell_handler_) {
+    if (!writer_) {
         LogError << "shell handler not ready";
         return false;
     }
 
     LogInfo << VAR(contact);
 
-    bool ret = shell_handler_->write(MAA_FMT::format("u {}\nc\n", contact));
+    TouchEvent event { .type = TouchEvent::Type::Up, .contact = contact };
+    return writer_->write(MtouchWriter::encode({ event }, to_touch()));
+}
 
+bool MinitouchInput::gesture(const std::vector<TouchEvent>& events)
+{
+    if (!writer_) {
+        LogError << "shell handler not ready";
+        return false;
+    }
+
+    auto chunks = MtouchWriter::encode(events, to_touch());
+    LogInfo << VAR(events.size()) << VAR(chunks.size());
+
+    bool ret = writer_->write(std::move(chunks));
     if (!ret) {
         LogError << "failed to write";
         return false;
     }
-
     return ret;
 }
 
+MtouchWriter::ToTouch MinitouchInput::to_touch()
+{
+    return [this](int x, int y) { return screen_to_touch(x, y); };
+}
+
 MAA_CTRL_UNIT_NS_END
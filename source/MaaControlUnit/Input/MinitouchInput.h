@@ -3,6 +3,7 @@
 #include "UnitBase.h"
 
 #include "Invoke/InvokeApp.h"
+#include "MtouchWriter.h"
 
 MAA_CTRL_UNIT_NS_BEGIN
 
@@ -26,6 +27,7 @@ public: // from TouchInputAPI
     virtual bool touch_down(int contact, int x, int y, int pressure) override;
     virtual bool touch_move(int contact, int x, int y, int pressure) override;
     virtual bool touch_up(int contact) override;
+    virtual bool gesture(const std::vector<TouchEvent>& events) override;
 
 private:
     template <typename T1, typename T2>
@@ -48,8 +50,12 @@ private:
         }
     }
 
+    MtouchWriter::ToTouch to_touch();
+
     std::shared_ptr<InvokeApp> invoke_app_ = std::make_shared<InvokeApp>();
     std::shared_ptr<IOHandler> shell_handler_ = nullptr;
+    // 所有写入都经过它，保证顺序
+    std::shared_ptr<MtouchWriter> writer_ = nullptr;
 
     std::string root_;
     std::vector<std::string> arch_list_;
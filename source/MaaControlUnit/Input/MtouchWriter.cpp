@@ -0,0 +1,184 @@
+#include "MtouchWriter.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "Utils/Format.hpp"
+#include "Utils/Logger.h"
+
+MAA_CTRL_UNIT_NS_BEGIN
+
+MtouchWriter::MtouchWriter(std::shared_ptr<IOHandler> handler) : handler_(std::move(handler))
+{
+    thread_ = std::thread(&MtouchWriter::working, this);
+}
+
+MtouchWriter::~MtouchWriter()
+{
+    {
+        std::unique_lock lock { mutex_ };
+        exit_ = true;
+    }
+    cond_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+bool MtouchWriter::write(std::vector<Chunk> chunks)
+{
+    if (chunks.empty()) {
+        return true;
+    }
+
+    auto done = std::make_shared<std::promise<bool>>();
+    auto future = done->get_future();
+    {
+        std::unique_lock lock { mutex_ };
+        if (exit_) {
+            return false;
+        }
+        queue_.emplace_back(Batch { .chunks = std::move(chunks), .done = std::move(done) });
+    }
+    cond_.notify_all();
+
+    return future.get();
+}
+
+bool MtouchWriter::post_move(int contact, std::string data)
+{
+    bool failed = false;
+    {
+        std::unique_lock lock { mutex_ };
+        if (exit_) {
+            return false;
+        }
+        failed = std::exchange(move_failed_, false);
+
+        // 只在队尾连续的 move 里找，前面有 down / up 的不能越过去
+        for (auto it = queue_.rbegin(); it != queue_.rend() && it->move_contact; ++it) {
+            if (*it->move_contact == contact) {
+                it->chunks.front().data = std::move(data);
+                return !failed;
+            }
+        }
+        queue_.emplace_back(Batch { .chunks = { Chunk { .data = std::move(data) } }, .move_contact = contact });
+    }
+    cond_.notify_all();
+    return !failed;
+}
+
+std::vector<MtouchWriter::Chunk> MtouchWriter::encode(const std::vector<TouchEvent>& events, const ToTouch& to_touch)
+{
+    auto sorted = events;
+    std::ranges::stable_sort(sorted, {}, &TouchEvent::time);
+
+    struct Pending
+    {
+        int contact = 0;
+        TouchEvent::Type type = TouchEvent::Type::Move;
+        std::string line;
+    };
+
+    std::vector<Chunk> chunks;
+    std::vector<Pending> pending;
+    int pending_time = 0;
+
+    auto commit = [&]() {
+        if (pending.empty()) {
+            return;
+        }
+        std::string data;
+        for (const auto& p : pending) {
+            data += p.line;
+        }
+        data += "c\n";
+        chunks.emplace_back(Chunk { .time = std::chrono::milliseconds(pending_time), .data = std::move(data) });
+        pending.clear();
+    };
+
+    for (const auto& event : sorted) {
+        if (!pending.empty() && event.time != pending_time) {
+            commit();
+        }
+
+        std::string line;
+        switch (event.type) {
+        case TouchEvent::Type::Down: {
+            auto [x, y] = to_touch(event.x, event.y);
+            line = MAA_FMT::format("d {} {} {} {}\n", event.contact, x, y, event.pressure);
+        } break;
+        case TouchEvent::Type::Move: {
+            auto [x, y] = to_touch(event.x, event.y);
+            line = MAA_FMT::format("m {} {} {} {}\n", event.contact, x, y, event.pressure);
+        } break;
+        case TouchEvent::Type::Up:
+            line = MAA_FMT::format("u {}\n", event.contact);
+            break;
+        }
+
+        // 一次提交里每个触点只能有一个事件：连续的 move 合并，其余情况先把前面的提交掉
+        auto it = std::ranges::find(pending, event.contact, &Pending::contact);
+        if (it != pending.end()) {
+            if (it->type == TouchEvent::Type::Move && event.type == TouchEvent::Type::Move) {
+                it->line = std::move(line);
+                continue;
+            }
+            commit();
+        }
+
+        pending_time = event.time;
+        pending.emplace_back(Pending { .contact = event.contact, .type = event.type, .line = std::move(line) });
+    }
+    commit();
+
+    return chunks;
+}
+
+void MtouchWriter::working()
+{
+    LogFunc;
+
+    while (true) {
+        Batch batch;
+        {
+            std::unique_lock lock { mutex_ };
+            cond_.wait(lock, [&]() { return exit_ || !queue_.empty(); });
+            if (exit_) {
+                break;
+            }
+            batch = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        bool ret = true;
+        for (const auto& chunk : batch.chunks) {
+            std::this_thread::sleep_until(start + chunk.time);
+            if (!handler_->write(chunk.data)) {
+                LogError << "failed to write" << VAR(chunk.data);
+                ret = false;
+                break;
+            }
+        }
+
+        if (batch.done) {
+            batch.done->set_value(ret);
+        }
+        else if (!ret) {
+            std::unique_lock lock { mutex_ };
+            move_failed_ = true;
+        }
+    }
+
+    // 没来得及写的，等着的都算失败
+    std::unique_lock lock { mutex_ };
+    for (auto& batch : queue_) {
+        if (batch.done) {
+            batch.done->set_value(false);
+        }
+    }
+    queue_.clear();
+}
+
+MAA_CTRL_UNIT_NS_END
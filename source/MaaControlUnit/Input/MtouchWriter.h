@@ -0,0 +1,64 @@
+#pragma once
+
+#include "ControlUnit/ControlUnitAPI.h"
+#include "Platform/PlatformIO.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+MAA_CTRL_UNIT_NS_BEGIN
+
+// minitouch 协议（minitouch / maatouch 共用）的写入线程
+// 一段手势先整个编码成带时间点的提交块，再由这个线程按时间点写出去，不用每个点排一次队、写一次
+class MtouchWriter
+{
+public:
+    // 屏幕坐标转成触摸设备坐标
+    using ToTouch = std::function<std::pair<int, int>(int x, int y)>;
+
+    struct Chunk
+    {
+        std::chrono::milliseconds time {}; // 相对这一批开始
+        std::string data;                  // 以 "c\n" 结尾，一次提交
+    };
+
+public:
+    explicit MtouchWriter(std::shared_ptr<IOHandler> handler);
+    ~MtouchWriter();
+
+    // 按时间点全部写完才返回
+    bool write(std::vector<Chunk> chunks);
+    // 不等写出；排在队尾还没写出去的同一触点的 move 直接被这次替换
+    // 写线程已经退出，或者上次以来有没等结果的 move 写失败了，返回 false
+    bool post_move(int contact, std::string data);
+
+    // 同一时间点的事件放进一次提交，同一触点连续的 move 只留最后一个；pressure 原样写出去
+    static std::vector<Chunk> encode(const std::vector<TouchEvent>& events, const ToTouch& to_touch);
+
+private:
+    struct Batch
+    {
+        std::vector<Chunk> chunks;
+        std::optional<int> move_contact; // post_move 进来的，可以被合并
+        std::shared_ptr<std::promise<bool>> done;
+    };
+
+    void working();
+
+    std::shared_ptr<IOHandler> handler_;
+
+    std::deque<Batch> queue_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    bool exit_ = false;
+    bool move_failed_ = false; // post_move 进来的写失败了，留给下一次 post_move 报
+    std::thread thread_;
+};
+
+MAA_CTRL_UNIT_NS_END
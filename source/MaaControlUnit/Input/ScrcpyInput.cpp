@@ -0,0 +1,138 @@
+#include "ScrcpyInput.h"
+
+#include <thread>
+
+#include "Utils/Logger.h"
+
+MAA_CTRL_UNIT_NS_BEGIN
+
+using Action = ScrcpyServer::Action;
+
+bool ScrcpyInput::parse(const json::value& config)
+{
+    return server_->parse(config);
+}
+
+bool ScrcpyInput::init(int swidth, int sheight, int orientation)
+{
+    LogFunc << VAR(swidth) << VAR(sheight) << VAR(orientation);
+
+    screen_width_ = swidth;
+    screen_height_ = sheight;
+    return server_->start(swidth, sheight);
+}
+
+void ScrcpyInput::set_wh(int swidth, int sheight, int orientation)
+{
+    init(swidth, sheight, orientation);
+}
+
+bool ScrcpyInput::click(int x, int y)
+{
+    if (x < 0 || x >= screen_width_ || y < 0 || y >= screen_height_) {
+        LogWarn << "click point out of range" << VAR(x) << VAR(y);
+        x = std::clamp(x, 0, screen_width_ - 1);
+        y = std::clamp(y, 0, screen_height_ - 1);
+    }
+
+    LogInfo << VAR(x) << VAR(y);
+
+    bool ret = server_->inject_touch(Action::Down, 0, x, y) && server_->inject_touch(Action::Up, 0, x, y);
+    if (!ret) {
+        LogError << "failed to inject";
+        return false;
+    }
+
+    return ret;
+}
+
+bool ScrcpyInput::swipe(int x1, int y1, int x2, int y2, int duration)
+{
+    if (x1 < 0 || x1 >= screen_width_ || y1 < 0 || y1 >= screen_height_ || x2 < 0 || x2 >= screen_width_ || y2 < 0 ||
+        y2 >= screen_height_) {
+        LogWarn << "swipe point out of range" << VAR(x1) << VAR(y1) << VAR(x2) << VAR(y2);
+        x1 = std::clamp(x1, 0, screen_width_ - 1);
+        y1 = std::clamp(y1, 0, screen_height_ - 1);
+        x2 = std::clamp(x2, 0, screen_width_ - 1);
+        y2 = std::clamp(y2, 0, screen_height_ - 1);
+    }
+    if (duration <= 0) {
+        LogWarn << "duration out of range" << VAR(duration);
+        duration = 500;
+    }
+
+    LogInfo << VAR(x1) << VAR(y1) << VAR(x2) << VAR(y2) << VAR(duration);
+
+    bool ret = server_->inject_touch(Action::Down, 0, x1, y1);
+    if (!ret) {
+        LogError << "failed to inject";
+        return false;
+    }
+
+    constexpr double kInterval = 10; // ms
+    const int steps = static_cast<int>(duration / kInterval);
+    const std::chrono::milliseconds delay(static_cast<int>(kInterval));
+
+    auto now = std::chrono::steady_clock::now();
+    for (int i = 1; i <= steps; ++i) {
+        int x = x1 + (x2 - x1) * i / steps;
+        int y = y1 + (y2 - y1) * i / steps;
+        std::this_thread::sleep_until(now + delay);
+        now = std::chrono::steady_clock::now();
+
+        ret &= server_->inject_touch(Action::Move, 0, x, y);
+    }
+
+    std::this_thread::sleep_until(now + delay);
+    ret &= server_->inject_touch(Action::Up, 0, x2, y2);
+
+    if (!ret) {
+        LogError << "failed to inject";
+        return false;
+    }
+
+    return ret;
+}
+
+bool ScrcpyInput::touch_down(int contact, int x, int y, int pressure)
+{
+    // scrcpy 的压力只有按下和抬起两档
+    std::ignore = pressure;
+
+    LogInfo << VAR(contact) << VAR(x) << VAR(y);
+    last_point_[contact] = { x, y };
+    return server_->inject_touch(Action::Down, contact, x, y);
+}
+
+bool ScrcpyInput::touch_move(int contact, int x, int y, int pressure)
+{
+    std::ignore = pressure;
+
+    LogInfo << VAR(contact) << VAR(x) << VAR(y);
+    last_point_[contact] = { x, y };
+    return server_->inject_touch(Action::Move, contact, x, y);
+}
+
+bool ScrcpyInput::touch_up(int contact)
+{
+    LogInfo << VAR(contact);
+
+    auto [x, y] = last_point_[contact];
+    last_point_.erase(contact);
+    return server_->inject_touch(Action::Up, contact, x, y);
+}
+
+bool ScrcpyInput::press_key(int key)
+{
+    LogInfo << VAR(key);
+
+    bool ret = server_->inject_keycode(Action::Down, key) && server_->inject_keycode(Action::Up, key);
+    if (!ret) {
+        LogError << "failed to inject";
+        return false;
+    }
+
+    return ret;
+}
+
+MAA_CTRL_UNIT_NS_END
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "UnitBase.h"
+
+#include "Invoke/ScrcpyServer.h"
+
+MAA_CTRL_UNIT_NS_BEGIN
+
+class ScrcpyInput : public TouchInputBase, public KeyInputBase
+{
+public:
+    explicit ScrcpyInput(std::shared_ptr<ScrcpyServer> server) : server_(std::move(server))
+    {
+        TouchInputBase::children_.emplace_back(server_);
+        KeyInputBase::children_.emplace_back(server_);
+    }
+    virtual ~ScrcpyInput() override = default;
+
+public: // from UnitBase
+    virtual bool parse(const json::value& config) override;
+
+    virtual void set_io(std::shared_ptr<PlatformIO> io_ptr) override
+    {
+        TouchInputBase::set_io(io_ptr);
+        KeyInputBase::set_io(io_ptr);
+    }
+    virtual void set_replacement(Argv::replacement argv_replace) override
+    {
+        TouchInputBase::set_replacement(argv_replace);
+        KeyInputBase::set_replacement(argv_replace);
+    }
+    virtual void merge_replacement(Argv::replacement argv_replace, bool _override = true) override
+    {
+        TouchInputBase::merge_replacement(argv_replace, _override);
+        KeyInputBase::merge_replacement(argv_replace, _override);
+    }
+
+public: // from TouchInputAPI
+    virtual bool init(int swidth, int sheight, int orientation) override;
+    virtual void deinit() override {}
+    virtual void set_wh(int swidth, int sheight, int orientation) override;
+
+    virtual bool click(int x, int y) override;
+    virtual bool swipe(int x1, int y1, int x2, int y2, int duration) override;
+
+    virtual bool touch_down(int contact, int x, int y, int pressure) override;
+    virtual bool touch_move(int contact, int x, int y, int pressure) override;
+    virtual bool touch_up(int contact) override;
+
+public: // from KeyInputAPI
+    virtual bool press_key(int key) override;
+
+private:
+    std::shared_ptr<ScrcpyServer> server_;
+
+    int screen_width_ = 0;
+    int screen_height_ = 0;
+    std::map<int, std::pair<int, int>> last_point_; // 抬起时要带上最后的位置
+};
+
+MAA_CTRL_UNIT_NS_END
@@ -1,11 +1,95 @@
 #include "TapInput.h"
 
+#include "Utils/Format.hpp"
 #include "Utils/Logger.h"
+#include "Utils/Time.hpp"
 
+#include <algorithm>
 #include <tuple>
 
 MAA_CTRL_UNIT_NS_BEGIN
 
+std::optional<bool> PersistentShell::run(const std::shared_ptr<PlatformIO>& io, const std::vector<std::string>& cmd)
+{
+    using namespace std::chrono_literals;
+
+    auto shell_it = std::ranges::find(cmd, "shell");
+    if (!io || shell_it == cmd.end() || shell_it + 1 == cmd.end()) {
+        return std::nullopt;
+    }
+
+    std::vector<std::string> prefix(cmd.begin(), shell_it + 1);
+    std::string shell_cmd;
+    for (auto it = shell_it + 1; it != cmd.end(); ++it) {
+        shell_cmd += (shell_cmd.empty() ? "" : " ") + *it;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if (!handle_ || prefix != prefix_) {
+        auto sh_cmd = prefix;
+        // 设备端的 stderr 丢掉，和普通 command 一样不混进输出，也不漏到宿主进程的 stderr 上
+        sh_cmd.emplace_back("sh");
+        sh_cmd.emplace_back("2>/dev/null");
+        handle_ = io->interactive_shell(sh_cmd, false);
+        prefix_ = std::move(prefix);
+        if (!handle_) {
+            LogWarn << "failed to start persistent shell" << VAR(sh_cmd);
+            return std::nullopt;
+        }
+        LogInfo << "persistent shell started" << VAR(sh_cmd);
+    }
+
+    // 老的 adbd 没有 shell_v2 时总是分配 pty，写进去的命令会被回显出来
+    // 标记在命令里拆成两段写，回显里就不会出现完整的标记；命令的输出只取两个标记之间的
+    ++seq_;
+    std::string begin_marker = MAA_FMT::format("__MAA_SHELL_BEGIN_{}__", seq_);
+    std::string marker = MAA_FMT::format("__MAA_SHELL_DONE_{}__:", seq_);
+    std::string line = MAA_FMT::format(R"(echo "__MAA_SHELL_""BEGIN_{0}__"; {1}; echo "__MAA_SHELL_""DONE_{0}__:$?")",
+                                       seq_, shell_cmd);
+    if (!handle_->write(line + "\n")) {
+        LogWarn << "persistent shell is dead, restart next time";
+        handle_ = nullptr;
+        return std::nullopt;
+    }
+
+    // input swipe 可能要跑好几秒，给足时间
+    constexpr auto kTimeout = 20s;
+    auto start = std::chrono::steady_clock::now();
+    std::string output;
+    size_t pos = std::string::npos;
+    while (duration_since(start) < kTimeout) {
+        auto read_start = std::chrono::steady_clock::now();
+        auto res = handle_->read(1);
+        // 读超时会等满 1s，立刻返回空说明 shell 已经没了
+        if (res.empty() && duration_since(read_start) < 100ms) {
+            break;
+        }
+        output += res;
+        pos = output.find(marker);
+        if (pos != std::string::npos && output.find('\n', pos) != std::string::npos) {
+            break;
+        }
+    }
+
+    if (pos == std::string::npos) {
+        // 命令已经发出去了，不能再退回普通 command 重做一遍
+        LogError << "persistent shell no response, restart next time" << VAR(shell_cmd) << VAR(output);
+        handle_ = nullptr;
+        return false;
+    }
+
+    int exit_code = std::atoi(output.c_str() + pos + marker.size());
+    // 开始标记之前的是回显、提示符，或者上一条超时命令留下的输出
+    size_t begin = output.rfind(begin_marker, pos);
+    begin = begin == std::string::npos ? 0 : output.find('\n', begin) + 1;
+    output = begin < pos ? output.substr(begin, pos - begin) : std::string();
+    LogDebug << VAR(shell_cmd) << VAR(exit_code) << VAR(output) << VAR(duration_since(start));
+
+    // 和普通 command 一样，input 成功时没有任何输出
+    return exit_code == 0 && output.empty();
+}
+
 bool TapTouchInput::parse(const json::value& config)
 {
     return parse_argv("Click", config, click_argv_) && parse_argv("Swipe", config, swipe_argv_);
@@ -31,7 +115,11 @@ bool TapTouchInput::click(int x, int y)
     merge_replacement({ { "{X}", std::to_string(x) }, { "{Y}", std::to_string(y) } });
 
     LogDebug << VAR(x) << VAR(y);
-    auto cmd_ret = command(click_argv_.gen(argv_replace_));
+    auto argv = click_argv_.gen(argv_replace_);
+    if (auto shell_ret = shell_.run(io_ptr_, argv)) {
+        return *shell_ret;
+    }
+    auto cmd_ret = command(argv);
 
     return cmd_ret && cmd_ret->empty();
 }
@@ -45,7 +133,11 @@ bool TapTouchInput::swipe(int x1, int y1, int x2, int y2, int duration)
                         { "{X2}", std::to_string(x2) },
                         { "{Y2}", std::to_string(y2) },
                         { "{DURATION}", duration ? std::to_string(duration) : std::string() } });
-    auto cmd_ret = command(swipe_argv_.gen(argv_replace_));
+    auto argv = swipe_argv_.gen(argv_replace_);
+    if (auto shell_ret = shell_.run(io_ptr_, argv)) {
+        return *shell_ret;
+    }
+    auto cmd_ret = command(argv);
 
     return cmd_ret.has_value() && cmd_ret.value().empty();
 }
@@ -78,7 +170,11 @@ bool TapKeyInput::press_key(int key)
     LogInfo << VAR(key);
 
     merge_replacement({ { "{KEY}", std::to_string(key) } });
-    auto cmd_ret = command(press_key_argv_.gen(argv_replace_));
+    auto argv = press_key_argv_.gen(argv_replace_);
+    if (auto shell_ret = shell_.run(io_ptr_, argv)) {
+        return *shell_ret;
+    }
+    auto cmd_ret = command(argv);
 
     return cmd_ret.has_value() && cmd_ret.value().empty();
 }
@@ -1,9 +1,26 @@
 #pragma once
 
+#include <mutex>
+
 #include "UnitBase.h"
 
 MAA_CTRL_UNIT_NS_BEGIN
 
+// 常驻一个 adb shell，把 input 命令写进去执行，省掉每次起 adb 进程和新 shell 会话
+class PersistentShell
+{
+public:
+    // cmd 是完整的 "adb ... shell <command>"
+    // 返回 nullopt 表示常驻 shell 不可用且命令没有发出去，调用方可以退回普通的 command
+    std::optional<bool> run(const std::shared_ptr<PlatformIO>& io, const std::vector<std::string>& cmd);
+
+private:
+    std::mutex mutex_;
+    std::vector<std::string> prefix_;
+    std::shared_ptr<IOHandler> handle_;
+    uint64_t seq_ = 0;
+};
+
 class TapTouchInput : public TouchInputBase
 {
 public:
@@ -27,6 +44,7 @@ public: // from TouchInputAPI
 private:
     Argv click_argv_;
     Argv swipe_argv_;
+    PersistentShell shell_;
 };
 
 class TapKeyInput : public KeyInputBase
@@ -42,6 +60,7 @@ public: // from KeyInputAPI
 
 private:
     Argv press_key_argv_;
+    PersistentShell shell_;
 };
 
 MAA_CTRL_UNIT_NS_END
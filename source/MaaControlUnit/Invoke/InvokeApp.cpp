@@ -1,13 +1,28 @@
 #include "InvokeApp.h"
 
+#include "Utils/File.hpp"
+#include "Utils/Format.hpp"
 #include "Utils/Logger.h"
 #include "Utils/Platform.h"
 #include "Utils/Time.hpp"
 
 MAA_CTRL_UNIT_NS_BEGIN
 
+static uint64_t fnv1a_hash(std::string_view data)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : data) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
 bool InvokeApp::parse(const json::value& config)
 {
+    // CheckBin 是后加的，旧配置里没有也能用，只是每次都会推送
+    has_check_bin_ = parse_argv("CheckBin", config, check_bin_argv_);
+
     return parse_argv("Abilist", config, abilist_argv_) && parse_argv("SDK", config, sdk_argv_) &&
            parse_argv("PushBin", config, push_bin_argv_) && parse_argv("ChmodBin", config, chmod_bin_argv_) &&
            parse_argv("InvokeBin", config, invoke_bin_argv_) && parse_argv("InvokeApp", config, invoke_app_argv_);
@@ -17,7 +32,8 @@ bool InvokeApp::init(const std::string& force_temp)
 {
     LogFunc;
 
-    tempname_ = force_temp.empty() ? now_filestem() : force_temp;
+    fixed_name_ = !force_temp.empty();
+    tempname_ = fixed_name_ ? force_temp : now_filestem();
     return true;
 }
 
@@ -68,7 +84,25 @@ bool InvokeApp::push(const std::string& path)
         return false;
     }
 
-    std::string absolute_path = path_to_crt_string(std::filesystem::absolute(MAA_NS::path(path)));
+    auto local_path = std::filesystem::absolute(MAA_NS::path(path));
+    auto content = read_file<std::string>(local_path);
+
+    if (!fixed_name_) {
+        // 同名即同内容，只要确认一下设备上的文件是完整的就行
+        tempname_ = MAA_FMT::format("maa_{}_{:016x}", path_to_utf8_string(local_path.filename()), fnv1a_hash(content));
+    }
+
+    // 指定了文件名的（比如 minicap.so）名字里没有哈希，换了版本大小也可能一样，只能每次都推
+    if (!fixed_name_ && has_check_bin_ && !content.empty()) {
+        merge_replacement({ { "{BIN_WORKING_FILE}", tempname_ } });
+        auto check_ret = command(check_bin_argv_.gen(argv_replace_));
+        if (check_ret && std::strtoull(check_ret->c_str(), nullptr, 10) == content.size()) {
+            LogInfo << "already on device, skip push" << VAR(tempname_);
+            return true;
+        }
+    }
+
+    std::string absolute_path = path_to_crt_string(local_path);
     merge_replacement({ { "{BIN_PATH}", absolute_path }, { "{BIN_WORKING_FILE}", tempname_ } });
     auto cmd_ret = command(push_bin_argv_.gen(argv_replace_));
 
@@ -88,6 +122,7 @@ bool InvokeApp::chmod()
         return false;
     }
 
+    // 跳过了推送也照样 chmod，上次 chmod 没成功的话文件会一直不可执行
     merge_replacement({ { "{BIN_WORKING_FILE}", tempname_ } });
     auto cmd_ret = command(chmod_bin_argv_.gen(argv_replace_));
 
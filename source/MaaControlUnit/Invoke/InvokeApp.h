@@ -17,6 +17,7 @@ public:
 
     std::optional<std::vector<std::string>> abilist();
     std::optional<int> sdk();
+    // 没有指定文件名时，设备上的文件名由内容哈希决定，设备上已经有同名同大小的文件就跳过 push；指定了文件名的每次都推
     bool push(const std::string& path);
     bool chmod();
 
@@ -33,10 +34,13 @@ private:
     Argv sdk_argv_;
     Argv push_bin_argv_;
     Argv chmod_bin_argv_;
+    Argv check_bin_argv_;
     Argv invoke_bin_argv_;
     Argv invoke_app_argv_;
 
     std::string tempname_;
+    bool fixed_name_ = false;
+    bool has_check_bin_ = false;
 };
 
 MAA_CTRL_UNIT_NS_END
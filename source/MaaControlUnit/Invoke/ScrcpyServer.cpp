@@ -0,0 +1,395 @@
+#include "ScrcpyServer.h"
+
+#include <cstdlib>
+
+#include "Utils/Format.hpp"
+#include "Utils/Logger.h"
+#include "Utils/MatPool.hpp"
+#include "Utils/NoWarningCV.hpp"
+#include "Utils/Time.hpp"
+
+MAA_CTRL_UNIT_NS_BEGIN
+
+// 控制消息是大端
+static void put_be(std::string& out, uint64_t value, int bytes)
+{
+    for (int i = bytes - 1; i >= 0; --i) {
+        out.push_back(static_cast<char>((value >> (i * 8)) & 0xFF));
+    }
+}
+
+static void set_capture_options()
+{
+    // 实时流，别让 FFmpeg 攒帧；用户自己设了的话以用户的为准
+    constexpr const char* kKey = "OPENCV_FFMPEG_CAPTURE_OPTIONS";
+    constexpr const char* kOptions = "fflags;nobuffer|flags;low_delay";
+
+    if (std::getenv(kKey)) {
+        return;
+    }
+#ifdef _WIN32
+    _putenv_s(kKey, kOptions);
+#else
+    setenv(kKey, kOptions, 0);
+#endif
+}
+
+// 读到 eof 时 read 会立刻空着返回，和真的等满超时区分开；对端关了返回 nullopt
+static std::optional<std::string> read_or_eof(IOHandler& handle, unsigned timeout_sec)
+{
+    auto start_time = std::chrono::steady_clock::now();
+    auto data = handle.read(timeout_sec);
+    if (data.empty() && duration_since(start_time) < std::chrono::milliseconds(timeout_sec * 1000 / 2)) {
+        return std::nullopt;
+    }
+    return data;
+}
+
+ScrcpyServer::~ScrcpyServer()
+{
+    stop();
+}
+
+bool ScrcpyServer::parse(const json::value& config)
+{
+    auto popt = config.find<json::object>("prebuilt");
+    if (!popt) {
+        LogError << "Cannot find entry prebuilt";
+        return false;
+    }
+
+    auto sopt = popt->find<json::object>("scrcpy");
+    if (!sopt) {
+        LogError << "Cannot find entry prebuilt.scrcpy";
+        return false;
+    }
+
+    {
+        auto opt = sopt->find<json::value>("root");
+        if (!opt || !opt->is_string()) {
+            LogError << "Cannot find entry prebuilt.scrcpy.root";
+            return false;
+        }
+        root_ = opt->as_string();
+    }
+
+    {
+        auto opt = sopt->find<json::value>("version");
+        if (!opt || !opt->is_string()) {
+            LogError << "Cannot find entry prebuilt.scrcpy.version";
+            return false;
+        }
+        version_ = opt->as_string();
+    }
+
+    options_ = sopt->get("options", std::string("max_fps=60"));
+    port_ = sopt->get("port", port_);
+    relay_port_ = sopt->get("relay_port", port_ + 1);
+
+    return invoke_app_->parse(config) && parse_argv("ForwardSocket", config, forward_argv_);
+}
+
+bool ScrcpyServer::start(int swidth, int sheight)
+{
+    LogFunc << VAR(swidth) << VAR(sheight);
+
+    if (!io_ptr_) {
+        LogError << "io_ptr is nullptr";
+        return false;
+    }
+
+    std::unique_lock<std::mutex> locker(start_mutex_);
+    if (started_) {
+        if (alive_ && swidth == screen_width_ && sheight == screen_height_) {
+            return true;
+        }
+        // 转屏了视频大小跟着变，或者 server 已经挂了，都重开一次
+        stop_session();
+    }
+
+    if (!invoke_app_->init()) {
+        return false;
+    }
+    if (!invoke_app_->push(MAA_FMT::format("{}/scrcpy-server", root_))) {
+        return false;
+    }
+
+    merge_replacement({ { "{FOWARD_PORT}", std::to_string(port_) }, { "{LOCAL_SOCKET}", "scrcpy" } });
+    if (!command(forward_argv_.gen(argv_replace_))) {
+        return false;
+    }
+
+    server_handle_ = invoke_app_->invoke_app(MAA_FMT::format(
+        "com.genymobile.scrcpy.Server {} tunnel_forward=true audio=false control=true cleanup=true raw_stream=true {}",
+        version_, options_));
+    if (!server_handle_ || !wait_for_server()) {
+        LogError << "start scrcpy server failed";
+        server_handle_ = nullptr;
+        return false;
+    }
+
+    {
+        // scrcpy 会把宽高向下对齐到 8，解出第一帧之后以实际大小为准
+        std::unique_lock<std::mutex> frame_locker(frame_mutex_);
+        screen_width_ = swidth;
+        screen_height_ = sheight;
+        video_width_ = swidth & ~7;
+        video_height_ = sheight & ~7;
+    }
+
+    auto serial_host = argv_replace_["{ADB_SERIAL}"];
+    auto shp = serial_host.find(':');
+    std::string local = "127.0.0.1";
+    if (shp != std::string::npos) {
+        local = serial_host.substr(0, shp);
+    }
+
+    // 解码器在本机 relay_port_ 上等着，视频连接收到的数据原样转过去
+    quit_ = false;
+    alive_ = true;
+    decode_thread_ = std::thread(&ScrcpyServer::decode_thread, this);
+
+    // server 按 accept 的顺序区分，第一条是视频，第二条是控制
+    video_handle_ = io_ptr_->tcp(local, static_cast<unsigned short>(port_));
+    control_handle_ = video_handle_ ? io_ptr_->tcp(local, static_cast<unsigned short>(port_)) : nullptr;
+    relay_handle_ = control_handle_ ? connect_relay() : nullptr;
+    if (!relay_handle_) {
+        LogError << "connect scrcpy failed" << VAR(local) << VAR(port_) << VAR(relay_port_);
+        stop_session();
+        return false;
+    }
+
+    relay_thread_ = std::thread(&ScrcpyServer::relay_thread, this);
+    started_ = true;
+    return true;
+}
+
+void ScrcpyServer::stop()
+{
+    std::unique_lock<std::mutex> locker(start_mutex_);
+    stop_session();
+}
+
+void ScrcpyServer::stop_session()
+{
+    quit_ = true;
+    alive_ = false;
+    if (relay_thread_.joinable()) {
+        relay_thread_.join();
+    }
+    // 断开 relay，解码那边读到 eof 就退出了
+    relay_handle_ = nullptr;
+    if (decode_thread_.joinable()) {
+        decode_thread_.join();
+    }
+
+    {
+        std::unique_lock<std::mutex> control_locker(control_mutex_);
+        control_handle_ = nullptr;
+    }
+    video_handle_ = nullptr;
+    server_handle_ = nullptr;
+    started_ = false;
+
+    std::unique_lock<std::mutex> frame_locker(frame_mutex_);
+    frame_ = cv::Mat();
+}
+
+std::optional<cv::Mat> ScrcpyServer::latest_frame(std::chrono::milliseconds wait)
+{
+    std::unique_lock<std::mutex> locker(frame_mutex_);
+
+    uint64_t prev_seq = frame_seq_;
+    frame_cond_.wait_for(locker, wait, [&]() { return frame_seq_ != prev_seq || !alive_; });
+
+    // 流断了的话最后一帧就冻住了，不能再当成当前画面
+    if (!alive_) {
+        LogError << "scrcpy stream is down";
+        return std::nullopt;
+    }
+    if (frame_.empty()) {
+        return std::nullopt;
+    }
+
+    // frame_ 会被解码线程换掉，交出去的是一份拷贝
+    cv::Mat result = MatPool::get_instance().acquire(frame_.rows, frame_.cols, frame_.type());
+    frame_.copyTo(result);
+    return result;
+}
+
+bool ScrcpyServer::inject_touch(Action action, int contact, int x, int y)
+{
+    int screen_width = 0;
+    int screen_height = 0;
+    int video_width = 0;
+    int video_height = 0;
+    {
+        // 屏幕大小和视频大小一起取，start 在别的 lane 上改的时候也是一起改的
+        std::unique_lock<std::mutex> locker(frame_mutex_);
+        screen_width = screen_width_;
+        screen_height = screen_height_;
+        video_width = video_width_;
+        video_height = video_height_;
+    }
+    if (screen_width <= 0 || screen_height <= 0 || video_width <= 0 || video_height <= 0) {
+        LogError << "scrcpy not started";
+        return false;
+    }
+
+    // 转屏之后 server 直接按新方向出帧，screen_* 要等下次 start 才更新，这里按解出来的帧的方向换过来
+    if ((video_width > video_height) != (screen_width > screen_height)) {
+        std::swap(screen_width, screen_height);
+    }
+
+    // 消息里带的视频大小和 server 当前的不一致时，server 会直接丢掉这个事件
+    int video_x = static_cast<int>(int64_t(x) * video_width / screen_width);
+    int video_y = static_cast<int>(int64_t(y) * video_height / screen_height);
+
+    constexpr uint8_t kInjectTouchEvent = 2;
+    std::string message;
+    message.reserve(32);
+    put_be(message, kInjectTouchEvent, 1);
+    put_be(message, static_cast<uint8_t>(action), 1);
+    put_be(message, static_cast<uint64_t>(contact), 8);
+    put_be(message, video_x, 4);
+    put_be(message, video_y, 4);
+    put_be(message, video_width, 2);
+    put_be(message, video_height, 2);
+    put_be(message, action == Action::Up ? 0 : 0xFFFF, 2); // pressure, 16 位定点数
+    put_be(message, 0, 4);                                 // action button
+    put_be(message, 0, 4);                                 // buttons
+
+    return send_control(message);
+}
+
+bool ScrcpyServer::inject_keycode(Action action, int keycode)
+{
+    constexpr uint8_t kInjectKeycode = 0;
+    std::string message;
+    message.reserve(14);
+    put_be(message, kInjectKeycode, 1);
+    put_be(message, static_cast<uint8_t>(action), 1);
+    put_be(message, static_cast<uint32_t>(keycode), 4);
+    put_be(message, 0, 4); // repeat
+    put_be(message, 0, 4); // meta state
+
+    return send_control(message);
+}
+
+bool ScrcpyServer::wait_for_server()
+{
+    using namespace std::chrono_literals;
+
+    // server 打出设备信息之后就开始 accept 了
+    auto start_time = std::chrono::steady_clock::now();
+    std::string output;
+    while (duration_since(start_time) < 10s) {
+        auto res_opt = read_or_eof(*server_handle_, 2);
+        if (!res_opt) {
+            LogError << "scrcpy server exited";
+            return false;
+        }
+        auto& res = *res_opt;
+        if (res.empty()) {
+            continue;
+        }
+        LogInfo << "scrcpy output:" << res;
+        output.append(res);
+        if (output.find("Device:") != std::string::npos) {
+            return true;
+        }
+        if (output.find("ERROR") != std::string::npos) {
+            return false;
+        }
+    }
+
+    LogError << "wait for scrcpy server timeout";
+    return false;
+}
+
+std::shared_ptr<IOHandler> ScrcpyServer::connect_relay()
+{
+    using namespace std::chrono_literals;
+
+    // 解码线程的 listen 不一定已经起来了
+    auto start_time = std::chrono::steady_clock::now();
+    while (duration_since(start_time) < 5s) {
+        auto handle = io_ptr_->tcp("127.0.0.1", static_cast<unsigned short>(relay_port_));
+        if (handle) {
+            return handle;
+        }
+        std::this_thread::sleep_for(100ms);
+    }
+    return nullptr;
+}
+
+void ScrcpyServer::relay_thread()
+{
+    LogFunc;
+
+    while (!quit_) {
+        auto data = read_or_eof(*video_handle_, 1);
+        if (!data) {
+            LogError << "video socket closed";
+            break;
+        }
+        if (data->empty()) {
+            continue;
+        }
+        if (!relay_handle_->write(*data)) {
+            LogError << "relay video failed";
+            break;
+        }
+    }
+    mark_down();
+}
+
+void ScrcpyServer::decode_thread()
+{
+    LogFunc;
+
+    set_capture_options();
+
+    auto url = MAA_FMT::format("tcp://127.0.0.1:{}?listen=1&listen_timeout=10000", relay_port_);
+    cv::VideoCapture capture(url, cv::CAP_FFMPEG);
+    if (!capture.isOpened()) {
+        LogError << "open video stream failed" << VAR(url);
+        mark_down();
+        return;
+    }
+
+    cv::Mat frame;
+    while (!quit_) {
+        if (!capture.read(frame) || frame.empty()) {
+            LogError << "video stream ended";
+            break;
+        }
+
+        std::unique_lock<std::mutex> locker(frame_mutex_);
+        std::swap(frame_, frame);
+        video_width_ = frame_.cols;
+        video_height_ = frame_.rows;
+        ++frame_seq_;
+        frame_cond_.notify_all();
+    }
+    mark_down();
+}
+
+void ScrcpyServer::mark_down()
+{
+    std::unique_lock<std::mutex> locker(frame_mutex_);
+    alive_ = false;
+    frame_cond_.notify_all();
+}
+
+bool ScrcpyServer::send_control(const std::string& message)
+{
+    std::unique_lock<std::mutex> locker(control_mutex_);
+    if (!control_handle_) {
+        LogError << "control socket is not connected";
+        return false;
+    }
+    return control_handle_->write(message);
+}
+
+MAA_CTRL_UNIT_NS_END
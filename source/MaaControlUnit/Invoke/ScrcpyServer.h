@@ -0,0 +1,89 @@
+#pragma once
+
+#include "UnitBase.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "Invoke/InvokeApp.h"
+
+MAA_CTRL_UNIT_NS_BEGIN
+
+// 一个 scrcpy-server 会话，截图和输入共用
+// 视频走第一条连接（raw H.264），控制消息走第二条，两条都在同一个 adb forward 上
+class ScrcpyServer : public UnitBase
+{
+public:
+    enum class Action : uint8_t
+    {
+        Down = 0,
+        Up = 1,
+        Move = 2,
+    };
+
+public:
+    ScrcpyServer() { children_.emplace_back(invoke_app_); }
+    virtual ~ScrcpyServer() override;
+
+public: // from UnitBase
+    virtual bool parse(const json::value& config) override;
+
+public:
+    // 截图和输入都会调，只有第一次（或者流断了之后）真正启动
+    bool start(int swidth, int sheight);
+    void stop();
+
+    // 等下一帧，静止画面 scrcpy 也会按编码器的设置重复发帧，等不到就给最近的一帧；流断了返回 nullopt
+    std::optional<cv::Mat> latest_frame(std::chrono::milliseconds wait);
+
+    // 坐标是屏幕坐标，发出去之前换算成视频大小
+    bool inject_touch(Action action, int contact, int x, int y);
+    bool inject_keycode(Action action, int keycode);
+
+private:
+    void stop_session();
+    bool wait_for_server();
+    std::shared_ptr<IOHandler> connect_relay();
+    void relay_thread();
+    void decode_thread();
+    // 转发或者解码线程退出了，流就断了
+    void mark_down();
+    bool send_control(const std::string& message);
+
+    std::shared_ptr<InvokeApp> invoke_app_ = std::make_shared<InvokeApp>();
+    Argv forward_argv_;
+
+    std::string root_;
+    std::string version_;
+    std::string options_;
+    int port_ = 1314;
+    int relay_port_ = 0;
+
+    std::mutex start_mutex_;
+    bool started_ = false;
+    // screen_* 要同时拿着 start_mutex_ 和 frame_mutex_ 才能改，video_* 只要 frame_mutex_
+    int screen_width_ = 0;
+    int screen_height_ = 0;
+    int video_width_ = 0;
+    int video_height_ = 0;
+
+    std::shared_ptr<IOHandler> server_handle_;
+    std::shared_ptr<IOHandler> video_handle_;
+    std::shared_ptr<IOHandler> control_handle_;
+    std::shared_ptr<IOHandler> relay_handle_;
+    std::mutex control_mutex_;
+
+    std::atomic_bool quit_ = true;
+    std::atomic_bool alive_ = false;
+    std::thread relay_thread_;
+    std::thread decode_thread_;
+
+    std::mutex frame_mutex_;
+    std::condition_variable frame_cond_;
+    cv::Mat frame_;
+    uint64_t frame_seq_ = 0;
+};
+
+MAA_CTRL_UNIT_NS_END
@@ -0,0 +1,531 @@
+#include "AdbSocketIO.h"
+
+#include <cstring>
+#include <fstream>
+
+#include "Utils/Format.hpp"
+#include "Utils/Logger.h"
+#include "Utils/Platform.h"
+
+MAA_CTRL_UNIT_NS_BEGIN
+
+using boost::asio::ip::tcp;
+using Clock = std::chrono::steady_clock;
+
+static constexpr std::string_view kExitCodeMark = "__MAA_ADB_EXIT_CODE__:";
+static constexpr size_t kSyncMaxChunk = 64 * 1024;
+
+// 所有 socket 操作都是异步发起，再把 io_context 跑到 deadline 为止，超时就 cancel
+static bool run_until(boost::asio::io_context& ios, tcp::socket& sock, Clock::time_point deadline)
+{
+    ios.restart();
+    ios.run_until(deadline);
+    if (ios.stopped()) {
+        return true;
+    }
+
+    boost::system::error_code ec;
+    sock.cancel(ec);
+    ios.restart();
+    ios.run();
+    return false;
+}
+
+static bool write_all(boost::asio::io_context& ios, tcp::socket& sock, std::string_view data,
+                      Clock::time_point deadline)
+{
+    boost::system::error_code error = boost::asio::error::would_block;
+    boost::asio::async_write(sock, boost::asio::buffer(data),
+                             [&](const boost::system::error_code& ec, size_t) { error = ec; });
+    return run_until(ios, sock, deadline) && !error;
+}
+
+static bool read_exact(boost::asio::io_context& ios, tcp::socket& sock, char* buffer, size_t size,
+                       Clock::time_point deadline)
+{
+    boost::system::error_code error = boost::asio::error::would_block;
+    boost::asio::async_read(sock, boost::asio::buffer(buffer, size),
+                            [&](const boost::system::error_code& ec, size_t) { error = ec; });
+    return run_until(ios, sock, deadline) && !error;
+}
+
+static bool read_to_eof(boost::asio::io_context& ios, tcp::socket& sock, std::string& data,
+                        Clock::time_point deadline)
+{
+    boost::system::error_code error = boost::asio::error::would_block;
+    boost::asio::async_read(sock, boost::asio::dynamic_buffer(data),
+                            [&](const boost::system::error_code& ec, size_t) { error = ec; });
+    return run_until(ios, sock, deadline) && error == boost::asio::error::eof;
+}
+
+static void append_le32(std::string& data, uint32_t value)
+{
+    for (int i = 0; i < 4; ++i) {
+        data.push_back(static_cast<char>((value >> (i * 8)) & 0xFF));
+    }
+}
+
+static uint32_t parse_le32(const char* data)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+        value |= static_cast<uint32_t>(static_cast<uint8_t>(data[i])) << (i * 8);
+    }
+    return value;
+}
+
+static std::string sync_packet(std::string_view id, std::string_view payload)
+{
+    std::string packet(id);
+    append_le32(packet, static_cast<uint32_t>(payload.size()));
+    packet.append(payload);
+    return packet;
+}
+
+static bool read_fail_message(boost::asio::io_context& ios, tcp::socket& sock, size_t size,
+                              Clock::time_point deadline)
+{
+    std::string message(size, '\0');
+    if (!read_exact(ios, sock, message.data(), message.size(), deadline)) {
+        LogError << "failed to read fail message";
+        return false;
+    }
+    LogError << "adb failed" << VAR(message);
+    return true;
+}
+
+// host 协议：4 位十六进制长度 + 服务名，回复 OKAY 或 FAIL + 4 位十六进制长度 + 错误信息
+static bool request(boost::asio::io_context& ios, tcp::socket& sock, std::string_view service,
+                    Clock::time_point deadline)
+{
+    std::string message = MAA_FMT::format("{:04x}{}", service.size(), service);
+    if (!write_all(ios, sock, message, deadline)) {
+        LogError << "failed to send request" << VAR(service);
+        return false;
+    }
+
+    char status[4] = { 0 };
+    if (!read_exact(ios, sock, status, sizeof(status), deadline)) {
+        LogError << "failed to read status" << VAR(service);
+        return false;
+    }
+    if (std::memcmp(status, "OKAY", 4) == 0) {
+        return true;
+    }
+
+    char len_hex[5] = { 0 };
+    if (std::memcmp(status, "FAIL", 4) == 0 && read_exact(ios, sock, len_hex, 4, deadline)) {
+        read_fail_message(ios, sock, std::strtoul(len_hex, nullptr, 16), deadline);
+    }
+    LogError << "request failed" << VAR(service);
+    return false;
+}
+
+static Clock::time_point make_deadline(int64_t timeout)
+{
+    using namespace std::chrono_literals;
+    // 和 BoostIO 一样，0 表示不限时
+    return Clock::now() + (timeout > 0 ? std::chrono::milliseconds(timeout) : std::chrono::milliseconds(24h));
+}
+
+static std::string join_args(const std::vector<std::string>& args)
+{
+    std::string result;
+    for (const auto& arg : args) {
+        if (!result.empty()) {
+            result.push_back(' ');
+        }
+        result.append(arg);
+    }
+    return result;
+}
+
+AdbSocketIO::AdbSocketIO() : BoostIO() {}
+
+int AdbSocketIO::call_command(const std::vector<std::string>& cmd, bool recv_by_socket, std::string& pipe_data,
+                              std::string& sock_data, int64_t timeout)
+{
+    // 数据走 netcat 回连的，仍然交给 BoostIO 去 accept
+    auto adb_cmd = recv_by_socket ? std::nullopt : parse_adb_command(cmd);
+    if (!adb_cmd) {
+        return BoostIO::call_command(cmd, recv_by_socket, pipe_data, sock_data, timeout);
+    }
+
+    std::optional<int> ret;
+    const std::string& sub = adb_cmd->subcommand;
+    auto timeout_ms = std::chrono::milliseconds(timeout);
+    if (sub == "shell") {
+        ret = shell(*adb_cmd, pipe_data, timeout_ms);
+    }
+    else if (sub == "exec-out") {
+        ret = exec_out(*adb_cmd, pipe_data, timeout_ms);
+    }
+    else if (sub == "push") {
+        ret = push(*adb_cmd, timeout_ms);
+    }
+    else if (sub == "pull") {
+        ret = pull(*adb_cmd, timeout_ms);
+    }
+    else if (sub == "forward") {
+        ret = forward(*adb_cmd, timeout_ms);
+    }
+
+    if (!ret) {
+        LogDebug << "fallback to adb process" << VAR(cmd);
+        pipe_data.clear();
+        return BoostIO::call_command(cmd, recv_by_socket, pipe_data, sock_data, timeout);
+    }
+    return *ret;
+}
+
+std::shared_ptr<IOHandler> AdbSocketIO::interactive_shell(const std::vector<std::string>& cmd, bool want_stderr)
+{
+    auto adb_cmd = parse_adb_command(cmd);
+    if (!adb_cmd || adb_cmd->subcommand != "shell") {
+        return BoostIO::interactive_shell(cmd, want_stderr);
+    }
+
+    auto ios = std::make_unique<boost::asio::io_context>();
+    auto deadline = make_deadline(20000);
+
+    auto sock = connect_transport(*ios, adb_cmd->serial);
+    if (!sock) {
+        return BoostIO::interactive_shell(cmd, want_stderr);
+    }
+
+    // exec: 不分配 pty，stdout 和 stderr 合在同一条流里，这里按 want_stderr 只留一种
+    std::string redirect = want_stderr ? "2>&1 >/dev/null" : "2>/dev/null";
+    std::string service = MAA_FMT::format("exec:{{ {}\n}} {}", join_args(adb_cmd->args), redirect);
+    if (!request(*ios, *sock, service, deadline)) {
+        return BoostIO::interactive_shell(cmd, want_stderr);
+    }
+
+    return std::make_shared<IOHandlerAdbSocket>(std::move(ios), std::move(*sock));
+}
+
+std::optional<AdbSocketIO::AdbCommand> AdbSocketIO::parse_adb_command(const std::vector<std::string>& cmd)
+{
+    if (cmd.size() < 2) {
+        return std::nullopt;
+    }
+
+    auto exec = path(cmd.front()).stem();
+    if (exec != path("adb")) {
+        return std::nullopt;
+    }
+
+    AdbCommand result;
+    size_t index = 1;
+    if (cmd[index] == "-s") {
+        if (cmd.size() < 4) {
+            return std::nullopt;
+        }
+        result.serial = cmd[index + 1];
+        index += 2;
+    }
+    result.subcommand = cmd[index];
+    result.args.assign(cmd.begin() + index + 1, cmd.end());
+    return result;
+}
+
+std::optional<int> AdbSocketIO::shell(const AdbCommand& adb_cmd, std::string& output,
+                                      std::chrono::milliseconds timeout)
+{
+    boost::asio::io_context ios;
+    auto deadline = make_deadline(timeout.count());
+
+    auto sock = connect_transport(ios, adb_cmd.serial);
+    if (!sock) {
+        return std::nullopt;
+    }
+
+    // adb shell 只把 stdout 交给我们，退出码用一行标记带回来
+    std::string service =
+        MAA_FMT::format("exec:{{ {}\n}} 2>/dev/null; echo \"{}$?\"", join_args(adb_cmd.args), kExitCodeMark);
+    if (!request(ios, *sock, service, deadline)) {
+        return std::nullopt;
+    }
+
+    if (!read_to_eof(ios, *sock, output, deadline)) {
+        LogError << "read shell output failed or timeout" << VAR(adb_cmd.args);
+        return -1;
+    }
+
+    auto pos = output.rfind(kExitCodeMark);
+    if (pos == std::string::npos) {
+        LogError << "exit code not found" << VAR(adb_cmd.args);
+        return -1;
+    }
+    int exit_code = std::atoi(output.c_str() + pos + kExitCodeMark.size());
+    output.erase(pos);
+    return exit_code;
+}
+
+std::optional<int> AdbSocketIO::exec_out(const AdbCommand& adb_cmd, std::string& output,
+                                         std::chrono::milliseconds timeout)
+{
+    boost::asio::io_context ios;
+    auto deadline = make_deadline(timeout.count());
+
+    auto sock = connect_transport(ios, adb_cmd.serial);
+    if (!sock) {
+        return std::nullopt;
+    }
+
+    if (!request(ios, *sock, "exec:" + join_args(adb_cmd.args), deadline)) {
+        return std::nullopt;
+    }
+
+    if (!read_to_eof(ios, *sock, output, deadline)) {
+        LogError << "read exec-out output failed or timeout" << VAR(adb_cmd.args);
+        return -1;
+    }
+    return 0;
+}
+
+std::optional<int> AdbSocketIO::push(const AdbCommand& adb_cmd, std::chrono::milliseconds timeout)
+{
+    if (adb_cmd.args.size() != 2) {
+        return std::nullopt;
+    }
+    const auto& local = adb_cmd.args.at(0);
+    const auto& remote = adb_cmd.args.at(1);
+
+    std::ifstream ifs(path(local), std::ios::in | std::ios::binary);
+    if (!ifs.is_open()) {
+        LogError << "failed to open local file" << VAR(local);
+        return -1;
+    }
+    std::string content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+
+    boost::asio::io_context ios;
+    auto deadline = make_deadline(timeout.count());
+
+    auto sock = connect_transport(ios, adb_cmd.serial);
+    if (!sock) {
+        return std::nullopt;
+    }
+    if (!request(ios, *sock, "sync:", deadline)) {
+        return std::nullopt;
+    }
+
+    // 0100644，之后会再 chmod
+    std::string data = sync_packet("SEND", remote + ",33188");
+    for (size_t offset = 0; offset < content.size(); offset += kSyncMaxChunk) {
+        data.append(sync_packet("DATA", std::string_view(content).substr(offset, kSyncMaxChunk)));
+    }
+    data.append("DONE");
+    auto mtime = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch());
+    append_le32(data, static_cast<uint32_t>(mtime.count()));
+
+    if (!write_all(ios, *sock, data, deadline)) {
+        LogError << "failed to send file" << VAR(local) << VAR(remote);
+        return -1;
+    }
+
+    char resp[8] = { 0 };
+    if (!read_exact(ios, *sock, resp, sizeof(resp), deadline)) {
+        LogError << "failed to read sync response" << VAR(remote);
+        return -1;
+    }
+    if (std::memcmp(resp, "OKAY", 4) != 0) {
+        read_fail_message(ios, *sock, parse_le32(resp + 4), deadline);
+        return -1;
+    }
+
+    write_all(ios, *sock, sync_packet("QUIT", {}), deadline);
+    return 0;
+}
+
+std::optional<int> AdbSocketIO::pull(const AdbCommand& adb_cmd, std::chrono::milliseconds timeout)
+{
+    if (adb_cmd.args.size() != 2) {
+        return std::nullopt;
+    }
+    const auto& remote = adb_cmd.args.at(0);
+    const auto& local = adb_cmd.args.at(1);
+
+    boost::asio::io_context ios;
+    auto deadline = make_deadline(timeout.count());
+
+    auto sock = connect_transport(ios, adb_cmd.serial);
+    if (!sock) {
+        return std::nullopt;
+    }
+    if (!request(ios, *sock, "sync:", deadline)) {
+        return std::nullopt;
+    }
+
+    if (!write_all(ios, *sock, sync_packet("RECV", remote), deadline)) {
+        LogError << "failed to send RECV" << VAR(remote);
+        return -1;
+    }
+
+    std::string content;
+    while (true) {
+        char header[8] = { 0 };
+        if (!read_exact(ios, *sock, header, sizeof(header), deadline)) {
+            LogError << "failed to read sync header" << VAR(remote);
+            return -1;
+        }
+        uint32_t size = parse_le32(header + 4);
+
+        if (std::memcmp(header, "DONE", 4) == 0) {
+            break;
+        }
+        if (std::memcmp(header, "DATA", 4) != 0) {
+            read_fail_message(ios, *sock, size, deadline);
+            return -1;
+        }
+
+        size_t offset = content.size();
+        content.resize(offset + size);
+        if (!read_exact(ios, *sock, content.data() + offset, size, deadline)) {
+            LogError << "failed to read sync data" << VAR(remote);
+            return -1;
+        }
+    }
+    write_all(ios, *sock, sync_packet("QUIT", {}), deadline);
+
+    std::ofstream ofs(path(local), std::ios::out | std::ios::binary);
+    if (!ofs.is_open()) {
+        LogError << "failed to open local file" << VAR(local);
+        return -1;
+    }
+    ofs.write(content.data(), content.size());
+    return 0;
+}
+
+std::optional<int> AdbSocketIO::forward(const AdbCommand& adb_cmd, std::chrono::milliseconds timeout)
+{
+    if (adb_cmd.args.size() != 2) {
+        return std::nullopt;
+    }
+
+    boost::asio::io_context ios;
+    auto deadline = make_deadline(timeout.count());
+
+    auto sock = connect_server(ios);
+    if (!sock) {
+        return std::nullopt;
+    }
+
+    std::string prefix = adb_cmd.serial.empty() ? "host" : "host-serial:" + adb_cmd.serial;
+    std::string service = MAA_FMT::format("{}:forward:{};{}", prefix, adb_cmd.args.at(0), adb_cmd.args.at(1));
+    if (!request(ios, *sock, service, deadline)) {
+        return std::nullopt;
+    }
+
+    // 第一个 OKAY 表示 server 收到，后面还会有一次真正的结果
+    std::string rest;
+    read_to_eof(ios, *sock, rest, deadline);
+    if (rest.starts_with("FAIL")) {
+        LogError << "forward failed" << VAR(rest);
+        return -1;
+    }
+    return 0;
+}
+
+std::optional<tcp::socket> AdbSocketIO::connect_server(boost::asio::io_context& ios)
+{
+    tcp::socket sock(ios);
+    tcp::endpoint endpoint(boost::asio::ip::address_v4::loopback(), server_port_);
+
+    boost::system::error_code error = boost::asio::error::would_block;
+    sock.async_connect(endpoint, [&](const boost::system::error_code& ec) { error = ec; });
+
+    using namespace std::chrono_literals;
+    if (!run_until(ios, sock, Clock::now() + 1s) || error) {
+        LogDebug << "adb server not reachable" << VAR(server_port_) << VAR(error.message());
+        return std::nullopt;
+    }
+    return sock;
+}
+
+std::optional<tcp::socket> AdbSocketIO::connect_transport(boost::asio::io_context& ios, const std::string& serial)
+{
+    auto sock = connect_server(ios);
+    if (!sock) {
+        return std::nullopt;
+    }
+
+    using namespace std::chrono_literals;
+    std::string service = serial.empty() ? "host:transport-any" : "host:transport:" + serial;
+    if (!request(ios, *sock, service, Clock::now() + 5s)) {
+        return std::nullopt;
+    }
+    return sock;
+}
+
+IOHandlerAdbSocket::~IOHandlerAdbSocket()
+{
+    boost::system::error_code ec;
+    sock_.close(ec);
+}
+
+bool IOHandlerAdbSocket::write(std::string_view data)
+{
+    if (!sock_.is_open()) {
+        LogError << "socket is not opened";
+        return false;
+    }
+
+    using namespace std::chrono_literals;
+    return write_all(*ios_, sock_, data, Clock::now() + 5s);
+}
+
+std::string IOHandlerAdbSocket::read(unsigned timeout_sec)
+{
+    constexpr size_t kBufferSize = 4096;
+    char buffer[kBufferSize];
+
+    std::string result;
+
+    // 先等到有数据，再把已经到了的都读走
+    size_t read_num = read_some_for(buffer, kBufferSize, std::chrono::seconds(timeout_sec));
+    while (read_num > 0) {
+        result.append(buffer, read_num);
+
+        boost::system::error_code ec;
+        if (sock_.available(ec) == 0 || ec) {
+            break;
+        }
+        // 有数据可读，同步读不会阻塞
+        read_num = sock_.read_some(boost::asio::buffer(buffer, kBufferSize), ec);
+    }
+
+    return result;
+}
+
+std::string IOHandlerAdbSocket::read(unsigned timeout_sec, size_t expect)
+{
+    auto deadline = Clock::now() + std::chrono::seconds(timeout_sec);
+
+    std::string result(expect, '\0');
+    size_t received = 0;
+    while (received < expect && sock_.is_open()) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now());
+        if (remaining.count() <= 0) {
+            break;
+        }
+        size_t read_num = read_some_for(result.data() + received, expect - received, remaining);
+        if (read_num == 0) {
+            break;
+        }
+        received += read_num;
+    }
+    result.resize(received);
+
+    return result;
+}
+
+size_t IOHandlerAdbSocket::read_some_for(char* buffer, size_t size, std::chrono::milliseconds timeout)
+{
+    size_t read_num = 0;
+    sock_.async_read_some(boost::asio::buffer(buffer, size),
+                          [&](const boost::system::error_code&, size_t n) { read_num = n; });
+    run_until(*ios_, sock_, Clock::now() + timeout);
+    return read_num;
+}
+
+MAA_CTRL_UNIT_NS_END
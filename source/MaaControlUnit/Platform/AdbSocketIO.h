@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+
+#include "BoostIO.h"
+
+MAA_CTRL_UNIT_NS_BEGIN
+
+// 直接和本地 adb server (默认 tcp:5037) 说 host 协议，免得每条命令都起一个 adb 进程
+// 只接管 shell / exec-out / push / pull / forward，其余命令（devices、connect 等）以及 adb server 连不上时，仍走 BoostIO
+class AdbSocketIO : public BoostIO
+{
+public:
+    AdbSocketIO();
+    virtual ~AdbSocketIO() override = default;
+
+    virtual int call_command(const std::vector<std::string>& cmd, bool recv_by_socket, std::string& pipe_data,
+                             std::string& sock_data, int64_t timeout) override;
+
+    virtual std::shared_ptr<IOHandler> interactive_shell(const std::vector<std::string>& cmd,
+                                                         bool want_stderr) override;
+
+private:
+    struct AdbCommand
+    {
+        std::string serial; // 为空时用 transport-any
+        std::string subcommand;
+        std::vector<std::string> args;
+    };
+
+    static std::optional<AdbCommand> parse_adb_command(const std::vector<std::string>& cmd);
+
+    std::optional<int> shell(const AdbCommand& adb_cmd, std::string& output, std::chrono::milliseconds timeout);
+    std::optional<int> exec_out(const AdbCommand& adb_cmd, std::string& output, std::chrono::milliseconds timeout);
+    std::optional<int> push(const AdbCommand& adb_cmd, std::chrono::milliseconds timeout);
+    std::optional<int> pull(const AdbCommand& adb_cmd, std::chrono::milliseconds timeout);
+    std::optional<int> forward(const AdbCommand& adb_cmd, std::chrono::milliseconds timeout);
+
+    // 连上 adb server 并切换到 serial 对应设备的 transport
+    std::optional<boost::asio::ip::tcp::socket> connect_transport(boost::asio::io_context& ios,
+                                                                  const std::string& serial);
+    std::optional<boost::asio::ip::tcp::socket> connect_server(boost::asio::io_context& ios);
+
+    unsigned short server_port_ = 5037;
+};
+
+class IOHandlerAdbSocket : public IOHandler, NonCopyable
+{
+public:
+    IOHandlerAdbSocket(std::unique_ptr<boost::asio::io_context> ios, boost::asio::ip::tcp::socket&& socket)
+        : ios_(std::move(ios)), sock_(std::move(socket))
+    {}
+
+    virtual ~IOHandlerAdbSocket() override;
+
+    virtual bool write(std::string_view data) override;
+    virtual std::string read(unsigned timeout_sec) override;
+    virtual std::string read(unsigned timeout_sec, size_t expect) override;
+
+private:
+    size_t read_some_for(char* buffer, size_t size, std::chrono::milliseconds timeout);
+
+    std::unique_ptr<boost::asio::io_context> ios_;
+    boost::asio::ip::tcp::socket sock_;
+};
+
+MAA_CTRL_UNIT_NS_END
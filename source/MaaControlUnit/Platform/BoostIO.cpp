@@ -7,6 +7,40 @@
 
 MAA_CTRL_UNIT_NS_BEGIN
 
+static void cancel_io(boost::asio::ip::tcp::socket& sock)
+{
+    boost::system::error_code ignored;
+    sock.cancel(ignored);
+}
+
+static void cancel_io(boost::process::async_pipe& pipe)
+{
+    pipe.cancel();
+}
+
+// 用 initiate 发起一次异步读，跑到完成或超时为止，返回读到的字节数
+template <typename Stream, typename Initiate>
+static size_t read_for(boost::asio::io_context& ios, Stream& stream, std::chrono::milliseconds timeout,
+                       Initiate&& initiate)
+{
+    size_t transferred = 0;
+    boost::asio::steady_timer timer(ios, timeout);
+
+    initiate([&](const boost::system::error_code&, size_t read_num) {
+        transferred = read_num;
+        timer.cancel();
+    });
+    timer.async_wait([&](const boost::system::error_code& ec) {
+        if (ec != boost::asio::error::operation_aborted) {
+            cancel_io(stream);
+        }
+    });
+
+    ios.restart();
+    ios.run();
+    return transferred;
+}
+
 BoostIO::BoostIO() : ios_(std::make_shared<boost::asio::io_context>()), server_sock_(*ios_)
 {
     support_socket_ = true;
@@ -16,9 +50,46 @@ BoostIO::~BoostIO() {}
 
 int BoostIO::call_command(const std::vector<std::string>& cmd, bool recv_by_socket, std::string& pipe_data,
                           std::string& sock_data, int64_t timeout)
+{
+    if (!recv_by_socket) {
+        return run_command(cmd, pipe_data, nullptr, timeout);
+    }
+
+    return run_command(
+        cmd, pipe_data,
+        [&](boost::asio::ip::tcp::socket& sock, std::function<void()> on_done) {
+            boost::asio::async_read(sock, boost::asio::dynamic_buffer(sock_data),
+                                    [on_done](const boost::system::error_code&, size_t) { on_done(); });
+        },
+        timeout);
+}
+
+int BoostIO::call_command_to_buffer(const std::vector<std::string>& cmd, std::span<char> sock_buffer,
+                                    size_t& sock_received, int64_t timeout)
+{
+    std::string pipe_data;
+    sock_received = 0;
+
+    return run_command(
+        cmd, pipe_data,
+        [&](boost::asio::ip::tcp::socket& sock, std::function<void()> on_done) {
+            // 读满或者 eof 为止，直接落在调用方的 buffer 里，不清零也不扩容
+            boost::asio::async_read(sock, boost::asio::buffer(sock_buffer.data(), sock_buffer.size()),
+                                    [&sock_received, on_done](const boost::system::error_code&, size_t read_num) {
+                                        sock_received = read_num;
+                                        on_done();
+                                    });
+        },
+        timeout);
+}
+
+int BoostIO::run_command(const std::vector<std::string>& cmd, std::string& pipe_data, const SockReader& read_sock,
+                         int64_t timeout)
 {
     using namespace std::chrono;
 
+    const bool recv_by_socket = static_cast<bool>(read_sock);
+
     if (cmd.empty()) {
         LogError << "cmd is empty";
         return -1;
@@ -32,28 +103,82 @@ int BoostIO::call_command(const std::vector<std::string>& cmd, bool recv_by_sock
     // TODO: 想办法直接把cmd的后面塞进args
     std::vector<std::string> rcmd(cmd.begin() + 1, cmd.end());
 
-    boost::process::ipstream pout;
+    // 只有 accept 需要用 ios_，其余命令各用各的 io_context，可以并发
+    std::unique_lock<std::mutex> sock_lock(sock_mutex_, std::defer_lock);
+    boost::asio::io_context local_ios;
+    if (recv_by_socket) {
+        sock_lock.lock();
+        ios_->restart();
+    }
+    auto& ios = recv_by_socket ? *ios_ : local_ios;
+
+    boost::process::async_pipe pout(ios);
     boost::process::child proc(exec, boost::process::args(rcmd),
                                boost::process::std_in<boost::process::null, boost::process::std_out> pout,
                                boost::process::std_err > boost::process::null);
 
-    const auto start_time = std::chrono::steady_clock::now();
-    auto terminate = [&]() -> bool {
-        return !proc.running() || (timeout && timeout < duration_since(start_time).count());
+    const auto deadline = steady_clock::now() + milliseconds(timeout);
+    boost::asio::steady_timer timer(ios);
+    boost::asio::ip::tcp::socket sock(ios);
+    bool pipe_done = false;
+    bool sock_done = !recv_by_socket;
+    bool timed_out = false;
+
+    auto arm_timer = [&](steady_clock::time_point expiry) {
+        timer.expires_at(expiry);
+        timer.async_wait([&](const boost::system::error_code& ec) {
+            if (ec == boost::asio::error::operation_aborted) {
+                return;
+            }
+            timed_out = true;
+            boost::system::error_code ignored;
+            pout.cancel();
+            if (recv_by_socket) {
+                // server_sock_ 是共用的，只有自己在 accept 时才能取消
+                server_sock_.cancel(ignored);
+                sock.cancel(ignored);
+            }
+        });
+    };
+    auto check_done = [&]() {
+        if (pipe_done && sock_done) {
+            timer.cancel();
+        }
     };
 
+    boost::asio::async_read(pout, boost::asio::dynamic_buffer(pipe_data),
+                            [&](const boost::system::error_code&, size_t) {
+                                pipe_done = true;
+                                if (!sock_done && !timed_out) {
+                                    // 进程的输出已经结束，nc 的连接要么已经在排队，要么不会来了
+                                    constexpr auto kAcceptGrace = 3s;
+                                    auto expiry = steady_clock::now() + kAcceptGrace;
+                                    arm_timer(timeout ? std::min(deadline, expiry) : expiry);
+                                }
+                                check_done();
+                            });
+
     if (recv_by_socket) {
-        read_sock_data(sock_data, terminate);
-    }
-    else {
-        read_pipe_data(pout, pipe_data, terminate);
+        server_sock_.async_accept(sock, [&](const boost::system::error_code& ec) {
+            if (ec) {
+                LogError << "accept failed" << VAR(ec.message());
+                sock_done = true;
+                check_done();
+                return;
+            }
+            read_sock(sock, [&]() {
+                sock_done = true;
+                check_done();
+            });
+        });
     }
 
-    while (!terminate()) {
-        std::this_thread::yield();
+    if (timeout) {
+        arm_timer(deadline);
     }
+    ios.run();
 
-    if (proc.running()) {
+    if (timed_out && proc.running()) {
         LogWarn << "terminate" << VAR(exec);
         proc.terminate();
     }
@@ -89,30 +214,34 @@ std::shared_ptr<IOHandler> BoostIO::tcp(const std::string& target, unsigned shor
 {
     using namespace boost::asio::ip;
 
-    if (!ios_) {
-        LogError << "ios_ is nullptr";
-        return nullptr;
-    }
-
-    tcp::socket socket(*ios_);
+    // 每个长连接一个 io_context，读写互不干扰
+    auto ios = std::make_shared<boost::asio::io_context>();
+    tcp::socket socket(*ios);
 
-    socket.connect(tcp::endpoint(address::from_string(target), port));
+    boost::system::error_code error;
+    socket.connect(tcp::endpoint(address::from_string(target), port), error);
 
-    if (!socket.is_open()) {
-        LogError << "socket is not opened";
+    if (error || !socket.is_open()) {
+        LogError << "socket is not opened" << VAR(target) << VAR(port) << VAR(error.message());
         return nullptr;
     }
 
-    return std::make_shared<IOHandlerBoostSocket>(ios_, std::move(socket));
+    return std::make_shared<IOHandlerBoostSocket>(ios, std::move(socket));
 }
 
 std::shared_ptr<IOHandler> BoostIO::interactive_shell(const std::vector<std::string>& cmd, bool want_stderr)
 {
+    if (cmd.empty()) {
+        LogError << "cmd is empty";
+        return nullptr;
+    }
+
     // TODO: 想办法直接把cmd的后面塞进args
     std::vector<std::string> rcmd(cmd.begin() + 1, cmd.end());
 
+    auto ios = std::make_shared<boost::asio::io_context>();
     std::shared_ptr<boost::process::opstream> pin(new boost::process::opstream);
-    std::shared_ptr<boost::process::ipstream> pout(new boost::process::ipstream);
+    std::shared_ptr<boost::process::async_pipe> pout(new boost::process::async_pipe(*ios));
 
     std::shared_ptr<boost::process::child> proc(
         want_stderr ? new boost::process::child(boost::process::search_path(cmd[0]), boost::process::args(rcmd),
@@ -120,57 +249,13 @@ std::shared_ptr<IOHandler> BoostIO::interactive_shell(const std::vector<std::str
                     : new boost::process::child(boost::process::search_path(cmd[0]), boost::process::args(rcmd),
                                                 boost::process::std_in<*pin, boost::process::std_out> * pout));
 
-    return std::make_shared<IOHandlerBoostStream>(pout, pin, proc);
-}
-
-void BoostIO::read_sock_data(std::string& data, std::function<bool(void)> terminate)
-{
-    constexpr size_t kBufferSize = 128 * 1024;
-    auto buffer = std::make_unique<char[]>(kBufferSize);
-
-    auto socket = server_sock_.accept();
-    if (!socket.is_open()) {
-        LogError << "socket is not opened";
-        return;
-    }
-    boost::system::error_code error;
-    do {
-        memset(buffer.get(), 0, kBufferSize);
-        auto read_num = socket.read_some(boost::asio::mutable_buffer(buffer.get(), kBufferSize), error);
-        while (error != boost::asio::error::eof && read_num > 0) {
-            data.insert(data.end(), buffer.get(), buffer.get() + read_num);
-            read_num = socket.read_some(boost::asio::mutable_buffer(buffer.get(), kBufferSize), error);
-        }
-    } while (socket.is_open() && !terminate());
-}
-
-void BoostIO::read_pipe_data(boost::process::ipstream& pout, std::string& data, std::function<bool(void)> terminate)
-{
-    constexpr size_t kBufferSize = 128 * 1024;
-    auto buffer = std::make_unique<char[]>(kBufferSize);
-
-    do {
-        if (pout.rdbuf()->in_avail() == 0) {
-            char ch;
-            pout.read(&ch, 1);
-            if (pout.gcount() != 1) {
-                break;
-            }
-            data.push_back(ch);
-        }
-
-        memset(buffer.get(), 0, kBufferSize);
-        auto read_num = pout.readsome(buffer.get(), kBufferSize);
-        while (read_num > 0) {
-            data.insert(data.end(), buffer.get(), buffer.get() + read_num);
-            read_num = pout.readsome(buffer.get(), kBufferSize);
-        }
-    } while (!terminate());
+    return std::make_shared<IOHandlerBoostStream>(ios, pout, pin, proc);
 }
 
 IOHandlerBoostSocket::~IOHandlerBoostSocket()
 {
-    sock_.close();
+    boost::system::error_code ignored;
+    sock_.close(ignored);
 }
 
 bool IOHandlerBoostSocket::write(std::string_view data)
@@ -179,31 +264,31 @@ bool IOHandlerBoostSocket::write(std::string_view data)
         LogError << "socket is not opened";
         return false;
     }
-    sock_.write_some(boost::asio::buffer(data));
+
+    boost::system::error_code error;
+    boost::asio::write(sock_, boost::asio::buffer(data), error);
+    if (error) {
+        LogError << "write failed" << VAR(error.message());
+        return false;
+    }
     return true;
 }
 
 std::string IOHandlerBoostSocket::read(unsigned timeout_sec)
 {
-    auto start_time = std::chrono::steady_clock::now();
-    auto check_timeout = [&](const auto& start_time) -> bool {
-        using namespace std::chrono_literals;
-        return std::chrono::steady_clock::now() - start_time < timeout_sec * 1s;
-    };
-
-    constexpr size_t bufferSize = 4096;
-    char buffer[bufferSize];
+    constexpr size_t kBufferSize = 4096;
+    char buffer[kBufferSize];
 
-    std::string result;
+    size_t read_num = read_for(*ios_, sock_, std::chrono::seconds(timeout_sec), [&](auto&& handler) {
+        sock_.async_read_some(boost::asio::buffer(buffer, kBufferSize), std::move(handler));
+    });
+    std::string result(buffer, read_num);
 
+    // 已经到了的数据一并取走，不会阻塞
     boost::system::error_code error;
-    while (check_timeout(start_time) && sock_.is_open()) {
-        auto read_num = sock_.read_some(boost::asio::mutable_buffer(buffer, bufferSize), error);
-        while (error != boost::asio::error::eof && read_num > 0) {
-            result.insert(result.end(), buffer, buffer + read_num);
-            read_num = sock_.read_some(boost::asio::mutable_buffer(buffer, bufferSize), error);
-        }
-        break;
+    while (read_num > 0 && sock_.available(error) > 0 && !error) {
+        read_num = sock_.read_some(boost::asio::buffer(buffer, kBufferSize), error);
+        result.append(buffer, read_num);
     }
 
     return result;
@@ -211,27 +296,12 @@ std::string IOHandlerBoostSocket::read(unsigned timeout_sec)
 
 std::string IOHandlerBoostSocket::read(unsigned timeout_sec, size_t expect)
 {
-    auto start_time = std::chrono::steady_clock::now();
-    auto check_timeout = [&](const auto& start_time) -> bool {
-        using namespace std::chrono_literals;
-        return std::chrono::steady_clock::now() - start_time < timeout_sec * 1s;
-    };
-
-    constexpr size_t kBufferSize = 4096;
-    char buffer[kBufferSize] = { 0 };
+    std::string result(expect, '\0');
 
-    std::string result;
-
-    boost::system::error_code error;
-    while (expect > result.size() && sock_.is_open() && check_timeout(start_time)) {
-        auto maxi = std::min(kBufferSize, expect - result.size());
-        auto read_num = sock_.read_some(boost::asio::mutable_buffer(buffer, maxi), error);
-        while (error != boost::asio::error::eof && read_num > 0) {
-            result.insert(result.end(), buffer, buffer + read_num);
-            maxi = std::min(kBufferSize, expect - result.size());
-            read_num = sock_.read_some(boost::asio::mutable_buffer(buffer, maxi), error);
-        }
-    }
+    size_t read_num = read_for(*ios_, sock_, std::chrono::seconds(timeout_sec), [&](auto&& handler) {
+        boost::asio::async_read(sock_, boost::asio::buffer(result), std::move(handler));
+    });
+    result.resize(read_num);
 
     return result;
 }
@@ -257,57 +327,24 @@ bool IOHandlerBoostStream::write(std::string_view data)
 
 std::string IOHandlerBoostStream::read(unsigned timeout_sec)
 {
-    auto start_time = std::chrono::steady_clock::now();
-    auto check_timeout = [&](const auto& start_time) -> bool {
-        using namespace std::chrono_literals;
-        return std::chrono::steady_clock::now() - start_time < timeout_sec * 1s;
-    };
-
     constexpr size_t kBufferSize = 4096;
-    char buffer[kBufferSize] = { 0 };
+    char buffer[kBufferSize];
 
-    std::string result;
+    size_t read_num = read_for(*ios_, *out_, std::chrono::seconds(timeout_sec), [&](auto&& handler) {
+        out_->async_read_some(boost::asio::buffer(buffer, kBufferSize), std::move(handler));
+    });
 
-    // dirty hack
-    if (out_->rdbuf()->in_avail() == 0) {
-        out_->read(buffer, 1);
-        result.push_back(buffer[0]);
-    }
-
-    while (check_timeout(start_time)) {
-        auto read_num = out_->readsome(buffer, kBufferSize);
-        while (read_num > 0) {
-            result.insert(result.end(), buffer, buffer + read_num);
-            read_num = out_->readsome(buffer, kBufferSize);
-        }
-        break;
-    }
-
-    return result;
+    return std::string(buffer, read_num);
 }
 
 std::string IOHandlerBoostStream::read(unsigned timeout_sec, size_t expect)
 {
-    auto start_time = std::chrono::steady_clock::now();
-    auto check_timeout = [&](const auto& start_time) -> bool {
-        using namespace std::chrono_literals;
-        return std::chrono::steady_clock::now() - start_time < timeout_sec * 1s;
-    };
-
-    constexpr size_t bufferSize = 4096;
-    char buffer[bufferSize];
-
-    std::string result;
+    std::string result(expect, '\0');
 
-    while (expect > result.size() && check_timeout(start_time)) {
-        auto maxi = std::min(bufferSize, expect - result.size());
-        auto read_num = out_->readsome(buffer, maxi);
-        while (read_num > 0) {
-            result.insert(result.end(), buffer, buffer + read_num);
-            maxi = std::min(bufferSize, expect - result.size());
-            read_num = out_->readsome(buffer, maxi);
-        }
-    }
+    size_t read_num = read_for(*ios_, *out_, std::chrono::seconds(timeout_sec), [&](auto&& handler) {
+        boost::asio::async_read(*out_, boost::asio::buffer(result), std::move(handler));
+    });
+    result.resize(read_num);
 
     return result;
 }
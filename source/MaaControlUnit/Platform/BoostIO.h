@@ -1,6 +1,7 @@
 #pragma once
 
 #include <functional>
+#include <mutex>
 
 #include "PlatformIO.h"
 #include "Utils/Boost.hpp"
@@ -17,6 +18,8 @@ public:
 
     virtual int call_command(const std::vector<std::string>& cmd, bool recv_by_socket, std::string& pipe_data,
                              std::string& sock_data, int64_t timeout) override;
+    virtual int call_command_to_buffer(const std::vector<std::string>& cmd, std::span<char> sock_buffer,
+                                       size_t& sock_received, int64_t timeout) override;
 
     virtual std::optional<unsigned short> create_socket(const std::string& local_address) override;
     virtual void close_socket() noexcept override;
@@ -26,9 +29,14 @@ public:
                                                          bool want_stderr) override;
 
 private:
-    void read_sock_data(std::string& data, std::function<bool(void)> terminate);
-    void read_pipe_data(boost::process::ipstream& pout, std::string& data, std::function<bool(void)> terminate);
+    // 在 accept 到的 socket 上发起读取，读完调用 on_done
+    using SockReader = std::function<void(boost::asio::ip::tcp::socket& sock, std::function<void()> on_done)>;
 
+    int run_command(const std::vector<std::string>& cmd, std::string& pipe_data, const SockReader& read_sock,
+                    int64_t timeout);
+
+    // server_sock_ 挂在 ios_ 上，走 socket 的命令要串行
+    std::mutex sock_mutex_;
     std::shared_ptr<boost::asio::io_context> ios_;
     boost::asio::ip::tcp::acceptor server_sock_;
 };
@@ -54,9 +62,9 @@ private:
 class IOHandlerBoostStream : public IOHandler, NonCopyable
 {
 public:
-    IOHandlerBoostStream(std::shared_ptr<boost::process::ipstream> out, std::shared_ptr<boost::process::opstream> in,
-                         std::shared_ptr<boost::process::child> proc)
-        : out_(out), in_(in), proc_(proc)
+    IOHandlerBoostStream(std::shared_ptr<boost::asio::io_context> ios, std::shared_ptr<boost::process::async_pipe> out,
+                         std::shared_ptr<boost::process::opstream> in, std::shared_ptr<boost::process::child> proc)
+        : ios_(ios), out_(out), in_(in), proc_(proc)
     {}
 
     virtual ~IOHandlerBoostStream() override;
@@ -66,7 +74,8 @@ public:
     virtual std::string read(unsigned timeout_sec, size_t expect) override;
 
 private:
-    std::shared_ptr<boost::process::ipstream> out_;
+    std::shared_ptr<boost::asio::io_context> ios_;
+    std::shared_ptr<boost::process::async_pipe> out_;
     std::shared_ptr<boost::process::opstream> in_;
     std::shared_ptr<boost::process::child> proc_;
 };
@@ -2,11 +2,11 @@
 
 #include "Conf/Conf.h"
 
-#include "BoostIO.h"
+#include "AdbSocketIO.h"
 
 MAA_CTRL_UNIT_NS_BEGIN
 
-using NativeIO = BoostIO;
+using NativeIO = AdbSocketIO;
 
 class PlatformFactory
 {
@@ -3,7 +3,9 @@
 #include <chrono>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
+#include <vector>
 
 #include "Conf/Conf.h"
 
@@ -18,6 +20,9 @@ public:
 
     virtual int call_command(const std::vector<std::string>& cmd, bool recv_by_socket, std::string& pipe_data,
                              std::string& sock_data, int64_t timeout) = 0;
+    // socket 数据大小已知时（raw 截图）直接收进 sock_buffer，sock_received 为实际收到的字节数
+    virtual int call_command_to_buffer(const std::vector<std::string>& cmd, std::span<char> sock_buffer,
+                                       size_t& sock_received, int64_t timeout) = 0;
 
     virtual std::optional<unsigned short> create_socket(const std::string& local_address) = 0;
     virtual void close_socket() noexcept = 0;
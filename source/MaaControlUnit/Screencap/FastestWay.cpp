@@ -4,6 +4,8 @@
 #include "Utils/Logger.h"
 #include "Utils/NoWarningCV.hpp"
 
+#include <algorithm>
+#include <sstream>
 #include <unordered_set>
 
 MAA_CTRL_UNIT_NS_BEGIN
@@ -17,6 +19,7 @@ ScreencapFastestWay::ScreencapFastestWay()
         { Method::EncodeToFileAndPull, std::make_shared<ScreencapEncodeToFileAndPull>() },
         { Method::MinicapDirect, std::make_shared<MinicapDirect>() },
         { Method::MinicapStream, std::make_shared<MinicapStream>() },
+        { Method::TileStream, std::make_shared<ScreencapTileStream>() },
     };
 
     for (auto pair : units_) {
@@ -38,8 +41,18 @@ bool ScreencapFastestWay::init(int swidth, int sheight)
 {
     LogFunc;
 
+    screencap_helper_.set_wh(swidth, sheight);
+
+    if (!preferred_.empty() && init_preferred(swidth, sheight)) {
+        return true;
+    }
+
     for (auto pair : units_) {
+        if (inited_.contains(pair.first)) {
+            continue;
+        }
         pair.second->init(swidth, sheight);
+        inited_.emplace(pair.first);
     }
 
     return speed_test();
@@ -54,78 +67,329 @@ void ScreencapFastestWay::deinit()
     }
 
     method_ = Method::UnknownYet;
+    ranking_.clear();
+    inited_.clear();
+}
+
+void ScreencapFastestWay::set_preferred_methods(std::vector<std::string> methods)
+{
+    preferred_.clear();
+    for (const auto& name : methods) {
+        auto it = std::ranges::find_if(units_, [&](const auto& pair) { return to_string(pair.first) == name; });
+        if (it == units_.end()) {
+            LogWarn << "unknown method" << VAR(name);
+            continue;
+        }
+        preferred_.emplace_back(it->first);
+    }
+    LogInfo << VAR(methods) << VAR(preferred_.size());
+}
+
+std::vector<std::string> ScreencapFastestWay::get_preferred_methods() const
+{
+    std::vector<std::string> result;
+    for (Method method : ranking_) {
+        result.emplace_back(to_string(method));
+    }
+    return result;
+}
+
+bool ScreencapFastestWay::init_preferred(int swidth, int sheight)
+{
+    LogFunc;
+
+    // 只初始化上次最快的那个并截一张验证，其余的等到要切换时再初始化
+    Method method = preferred_.front();
+    auto& unit = units_[method];
+    if (!unit->init(swidth, sheight)) {
+        LogWarn << "preferred method init failed, fallback to speed test" << VAR(method);
+        unit->deinit();
+        return false;
+    }
+    inited_.emplace(method);
+
+    {
+        std::unique_lock<std::mutex> lock(stats_mutex_);
+        stats_.clear();
+    }
+    if (!timed_screencap(method)) {
+        LogWarn << "preferred method screencap failed, fallback to speed test" << VAR(method);
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(stats_mutex_);
+    stats_[method].baseline = stats_[method].median();
+    ranking_ = preferred_;
+    method_ = method;
+
+    LogInfo << "Use preferred method" << method_.load() << VAR(stats_[method].baseline);
+    return true;
+}
+
+bool ScreencapFastestWay::ensure_inited(Method method)
+{
+    if (inited_.contains(method)) {
+        return true;
+    }
+    if (!units_[method]->init(screencap_helper_.get_w(), screencap_helper_.get_h())) {
+        LogWarn << "init failed" << VAR(method);
+        return false;
+    }
+    inited_.emplace(method);
+    return true;
 }
 
 void ScreencapFastestWay::set_wh(int swidth, int sheight)
 {
     LogFunc;
+    screencap_helper_.set_wh(swidth, sheight);
     for (auto pair : units_) {
         pair.second->set_wh(swidth, sheight);
     }
 }
 
+void ScreencapFastestWay::set_target_size(int width, int height)
+{
+    for (auto pair : units_) {
+        pair.second->set_target_size(width, height);
+    }
+}
+
 std::optional<cv::Mat> ScreencapFastestWay::screencap()
 {
-    switch (method_) {
-    case Method::UnknownYet:
+    if (method_ == Method::UnknownYet) {
         LogError << "Unknown screencap method";
         return std::nullopt;
-    case Method::RawByNetcat:
-    case Method::RawWithGzip:
-    case Method::Encode:
-    case Method::EncodeToFileAndPull:
-    case Method::MinicapDirect:
-    case Method::MinicapStream:
-        return units_[method_]->screencap();
-    default:
-        LogInfo << "Not support:" << method_;
-        break;
     }
+
+    auto ret = timed_screencap(method_);
+    if (ret) {
+        reevaluate();
+        return ret;
+    }
+
+    // 偶尔失败一次不切换，这一张先按 speed_test 的排名往下找一个能用的顶上
+    // 连续失败 kFailoverThreshold 次才真的切过去
+    constexpr size_t kFailoverThreshold = 3;
+    bool failover = false;
+    {
+        std::unique_lock<std::mutex> lock(stats_mutex_);
+        failover = stats_[method_].consecutive_failure >= kFailoverThreshold;
+    }
+
+    Method current = method_;
+    for (Method method : ranking_) {
+        if (method == current || !ensure_inited(method)) {
+            continue;
+        }
+        ret = timed_screencap(method);
+        if (ret) {
+            if (failover) {
+                switch_to(method);
+            }
+            return ret;
+        }
+    }
+
+    LogError << "all screencap methods failed";
     return std::nullopt;
 }
 
+std::optional<std::vector<cv::Rect>> ScreencapFastestWay::changed_regions() const
+{
+    if (method_ == Method::UnknownYet) {
+        return std::nullopt;
+    }
+    return units_.at(method_)->changed_regions();
+}
+
+std::string ScreencapFastestWay::get_current_method() const
+{
+    Method method = method_;
+    return method == Method::UnknownYet ? std::string() : to_string(method);
+}
+
+std::vector<ScreencapMethodStats> ScreencapFastestWay::get_method_stats() const
+{
+    auto to_ms = [](std::chrono::milliseconds ms) {
+        return ms == std::chrono::milliseconds::max() ? int64_t(-1) : static_cast<int64_t>(ms.count());
+    };
+
+    std::unique_lock<std::mutex> lock(stats_mutex_);
+    std::vector<ScreencapMethodStats> result;
+    for (const auto& [method, stats] : stats_) {
+        result.emplace_back(ScreencapMethodStats {
+            .method = to_string(method),
+            .success = stats.success,
+            .failure = stats.failure,
+            .consecutive_failure = stats.consecutive_failure,
+            .median = to_ms(stats.median()),
+            .p90 = to_ms(stats.p90()),
+            .baseline = stats.success ? to_ms(stats.baseline) : -1,
+        });
+    }
+    return result;
+}
+
+std::optional<cv::Mat> ScreencapFastestWay::timed_screencap(Method method)
+{
+    constexpr size_t kStatsWindow = 32;
+
+    auto start = std::chrono::steady_clock::now();
+    auto ret = units_[method]->screencap();
+    auto duration = duration_since(start);
+
+    std::unique_lock<std::mutex> lock(stats_mutex_);
+    auto& stats = stats_[method];
+    if (!ret) {
+        ++stats.failure;
+        ++stats.consecutive_failure;
+        LogWarn << "screencap failed" << VAR(method) << VAR(stats.consecutive_failure);
+        return std::nullopt;
+    }
+
+    ++stats.success;
+    stats.consecutive_failure = 0;
+    stats.latencies.emplace_back(duration);
+    if (stats.latencies.size() > kStatsWindow) {
+        stats.latencies.pop_front();
+    }
+    return ret;
+}
+
+void ScreencapFastestWay::reevaluate()
+{
+    constexpr size_t kReevaluateInterval = 20;
+    constexpr double kRegressionRatio = 1.5;
+
+    if (++since_reevaluate_ < kReevaluateInterval) {
+        return;
+    }
+    since_reevaluate_ = 0;
+
+    std::unique_lock<std::mutex> lock(stats_mutex_);
+    const auto& current = stats_[method_];
+    auto current_median = current.median();
+    if (current_median.count() <= current.baseline.count() * kRegressionRatio) {
+        return;
+    }
+
+    // 变慢了，找一个最近没失败、而且明显更快的
+    Method best = Method::UnknownYet;
+    auto best_median = std::chrono::milliseconds::max();
+    for (Method method : ranking_) {
+        const auto& stats = stats_[method];
+        if (method == method_ || stats.consecutive_failure > 0 || stats.latencies.empty()) {
+            continue;
+        }
+        if (auto median = stats.median(); median < best_median) {
+            best = method;
+            best_median = median;
+        }
+    }
+
+    LogInfo << "screencap regressed" << VAR(method_.load()) << VAR(current_median) << VAR(current.baseline) << VAR(best)
+            << VAR(best_median);
+    if (best == Method::UnknownYet || best_median.count() * kRegressionRatio >= current_median.count()) {
+        return;
+    }
+
+    lock.unlock();
+    switch_to(best);
+}
+
+void ScreencapFastestWay::switch_to(Method method)
+{
+    LogWarn << "switch screencap method" << VAR(method_.load()) << "->" << VAR(method);
+    method_ = method;
+    since_reevaluate_ = 0;
+
+    // 以当前的表现作为新的基线
+    std::unique_lock<std::mutex> lock(stats_mutex_);
+    auto& stats = stats_[method];
+    stats.baseline = stats.median();
+}
+
 bool ScreencapFastestWay::speed_test()
 {
     LogFunc;
 
-    method_ = Method::UnknownYet;
-    std::chrono::milliseconds cost(INT64_MAX);
+    constexpr int kSamples = 3;
+    // 第一次明显比目前最好的慢很多的，不用再采样了
+    constexpr double kGiveUpRatio = 3;
 
-    auto check = [this, &cost](Method method, std::chrono::steady_clock::time_point start) {
-        auto duration = duration_since(start);
-        if (duration < cost) {
-            method_ = method;
-            cost = duration;
-        }
-        LogInfo << VAR(method) << VAR(duration);
-    };
+    method_ = Method::UnknownYet;
+    ranking_.clear();
+    {
+        std::unique_lock<std::mutex> lock(stats_mutex_);
+        stats_.clear();
+    }
 
     // RawByNetcat 第一次速度很慢，但后面快
-    // MinicapStream 是直接取数据，只取一次不准
-    const std::unordered_set<Method> kDropFirst = { Method::RawByNetcat, Method::MinicapStream };
+    // MinicapStream / TileStream 是直接取数据，只取一次不准
+    const std::unordered_set<Method> kDropFirst = { Method::RawByNetcat, Method::MinicapStream, Method::TileStream };
 
+    auto best_median = std::chrono::milliseconds::max();
     for (auto pair : units_) {
-        if (kDropFirst.contains(pair.first)) {
+        Method method = pair.first;
+        if (kDropFirst.contains(method)) {
             if (!pair.second->screencap()) {
                 continue;
             }
         }
 
-        auto now = std::chrono::steady_clock::now();
-        if (pair.second->screencap()) {
-            check(pair.first, now);
+        for (int i = 0; i < kSamples; ++i) {
+            if (!timed_screencap(method)) {
+                break;
+            }
+            std::unique_lock<std::mutex> lock(stats_mutex_);
+            if (best_median != std::chrono::milliseconds::max() &&
+                stats_[method].median().count() > best_median.count() * kGiveUpRatio) {
+                break;
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(stats_mutex_);
+        auto& stats = stats_[method];
+        if (stats.latencies.empty() || stats.consecutive_failure > 0) {
+            continue;
         }
+        stats.baseline = stats.median();
+        best_median = std::min(best_median, stats.baseline);
+        ranking_.emplace_back(method);
+        LogInfo << VAR(method) << "median" << stats.median() << "p90" << stats.p90();
     }
 
-    if (method_ == Method::UnknownYet) {
+    if (ranking_.empty()) {
         LogError << "cannot find any method to screencap!";
         return false;
     }
 
-    LogInfo << "The fastest method is" << method_ << VAR(cost);
+    std::unique_lock<std::mutex> lock(stats_mutex_);
+    // 中位数比较，相同时看 p90
+    std::ranges::sort(ranking_, [&](Method lhs, Method rhs) {
+        const auto& l = stats_[lhs];
+        const auto& r = stats_[rhs];
+        return std::make_pair(l.median(), l.p90()) < std::make_pair(r.median(), r.p90());
+    });
+    method_ = ranking_.front();
+
+    LogInfo << "The fastest method is" << method_.load() << "median" << stats_[method_].median();
     return true;
 }
 
+std::chrono::milliseconds ScreencapFastestWay::MethodStats::percentile(double p) const
+{
+    if (latencies.empty()) {
+        return std::chrono::milliseconds::max();
+    }
+
+    std::vector<std::chrono::milliseconds> sorted(latencies.begin(), latencies.end());
+    size_t index = std::min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()));
+    std::ranges::nth_element(sorted, sorted.begin() + index);
+    return sorted[index];
+}
+
 std::ostream& operator<<(std::ostream& os, ScreencapFastestWay::Method m)
 {
     switch (m) {
@@ -150,8 +414,18 @@ std::ostream& operator<<(std::ostream& os, ScreencapFastestWay::Method m)
     case ScreencapFastestWay::Method::MinicapStream:
         os << "MinicapStream";
         break;
+    case ScreencapFastestWay::Method::TileStream:
+        os << "TileStream";
+        break;
     }
     return os;
 }
 
+std::string to_string(ScreencapFastestWay::Method m)
+{
+    std::stringstream ss;
+    ss << m;
+    return ss.str();
+}
+
 MAA_CTRL_UNIT_NS_END
@@ -1,11 +1,19 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <vector>
+
 #include "Encode.h"
 #include "EncodeToFile.h"
 #include "Minicap/MinicapDirect.h"
 #include "Minicap/MinicapStream.h"
 #include "RawByNetcat.h"
 #include "RawWithGzip.h"
+#include "TileStream/TileStream.h"
 
 MAA_CTRL_UNIT_NS_BEGIN
 
@@ -21,6 +29,20 @@ public:
         EncodeToFileAndPull,
         MinicapDirect,
         MinicapStream,
+        TileStream,
+    };
+
+    struct MethodStats
+    {
+        size_t success = 0;
+        size_t failure = 0;
+        size_t consecutive_failure = 0;
+        std::deque<std::chrono::milliseconds> latencies; // 最近 kStatsWindow 次成功的耗时
+        std::chrono::milliseconds baseline { 0 };        // speed_test 时的中位数
+
+        std::chrono::milliseconds percentile(double p) const;
+        std::chrono::milliseconds median() const { return percentile(0.5); }
+        std::chrono::milliseconds p90() const { return percentile(0.9); }
     };
 
 public:
@@ -34,16 +56,36 @@ public: // from ScreencapAPI
     virtual bool init(int swidth, int sheight) override;
     virtual void deinit() override;
     virtual void set_wh(int swidth, int sheight) override;
+    virtual void set_target_size(int width, int height) override;
+    virtual void set_preferred_methods(std::vector<std::string> methods) override;
+    virtual std::vector<std::string> get_preferred_methods() const override;
+    virtual std::string get_current_method() const override;
+    virtual std::vector<ScreencapMethodStats> get_method_stats() const override;
 
     virtual std::optional<cv::Mat> screencap() override;
+    virtual std::optional<std::vector<cv::Rect>> changed_regions() const override;
 
 private:
+    bool init_preferred(int swidth, int sheight);
+    bool ensure_inited(Method method);
     bool speed_test();
+    std::optional<cv::Mat> timed_screencap(Method method);
+    void reevaluate();
+    void switch_to(Method method);
 
     std::map<Method, std::shared_ptr<ScreencapBase>> units_;
-    Method method_ = Method::UnknownYet;
+    std::atomic<Method> method_ = Method::UnknownYet; // 查询统计的线程也会读
+
+    mutable std::mutex stats_mutex_;
+    std::map<Method, MethodStats> stats_;
+    std::vector<Method> ranking_; // speed_test 结果，从快到慢
+    size_t since_reevaluate_ = 0;
+
+    std::vector<Method> preferred_;
+    std::set<Method> inited_;
 };
 
 std::ostream& operator<<(std::ostream& os, ScreencapFastestWay::Method m);
+std::string to_string(ScreencapFastestWay::Method m);
 
 MAA_CTRL_UNIT_NS_END
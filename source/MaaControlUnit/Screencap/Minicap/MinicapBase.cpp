@@ -136,4 +136,34 @@ bool MinicapBase::init(int swidth, int sheight)
     return true;
 }
 
+void MinicapBase::set_target_size(int width, int height)
+{
+    ScreencapBase::set_target_size(width, height);
+
+    // 清掉目标大小时沿用之前的，不然每次重算都要让设备端来回切
+    if (width > 0 && height > 0) {
+        virt_width_ = width;
+        virt_height_ = height;
+    }
+}
+
+std::pair<int, int> MinicapBase::virtual_size() const
+{
+    int width = screencap_helper_.get_w();
+    int height = screencap_helper_.get_h();
+
+    // minicap 只缩小不放大
+    if (virt_width_ > 0 && virt_height_ > 0 && virt_width_ <= width && virt_height_ <= height) {
+        return { virt_width_, virt_height_ };
+    }
+    return { width, height };
+}
+
+std::string MinicapBase::projection() const
+{
+    auto [virt_width, virt_height] = virtual_size();
+    return MAA_FMT::format("-P {}x{}@{}x{}/{}", screencap_helper_.get_w(), screencap_helper_.get_h(), virt_width,
+                           virt_height, 0);
+}
+
 MAA_CTRL_UNIT_NS_END
@@ -23,9 +23,14 @@ public: // from UnitBase
 public: // from ScreencapAPI
     virtual bool init(int swidth, int sheight) override;
     virtual void deinit() override {}
+    virtual void set_target_size(int width, int height) override;
     virtual std::optional<cv::Mat> screencap() override = 0;
 
 protected:
+    // 交给 minicap 的 -P 参数，让设备端直接缩到目标大小
+    std::pair<int, int> virtual_size() const;
+    std::string projection() const;
+
     std::shared_ptr<InvokeApp> binary_ = std::make_shared<InvokeApp>();
     std::shared_ptr<InvokeApp> library_ = std::make_shared<InvokeApp>();
 
@@ -33,6 +38,9 @@ private:
     std::string root_;
     std::vector<std::string> arch_list_;
     std::vector<int> sdk_list_;
+
+    int virt_width_ = 0;
+    int virt_height_ = 0;
 };
 
 MAA_CTRL_UNIT_NS_END
@@ -8,10 +8,10 @@ MAA_CTRL_UNIT_NS_BEGIN
 
 std::optional<cv::Mat> MinicapDirect::screencap()
 {
-    int width = screencap_helper_.get_w();
-    int height = screencap_helper_.get_h();
+    auto [virt_width, virt_height] = virtual_size();
+    screencap_helper_.set_frame_size(virt_width, virt_height);
 
-    auto res = binary_->invoke_bin_stdout(MAA_FMT::format("-P {}x{}@{}x{}/{} -s", width, height, width, height, 0));
+    auto res = binary_->invoke_bin_stdout(projection() + " -s");
 
     if (!res) {
         return std::nullopt;
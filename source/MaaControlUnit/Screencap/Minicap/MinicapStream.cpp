@@ -9,10 +9,7 @@ MAA_CTRL_UNIT_NS_BEGIN
 
 MinicapStream::~MinicapStream()
 {
-    quit_ = true;
-    if (pull_thread_.joinable()) {
-        pull_thread_.join();
-    }
+    stop_stream();
 }
 
 bool MinicapStream::parse(const json::value& config)
@@ -36,10 +33,29 @@ bool MinicapStream::init(int swidth, int sheight)
         return false;
     }
 
+    return start_stream();
+}
+
+void MinicapStream::set_target_size(int width, int height)
+{
+    MinicapBase::set_target_size(width, height);
+
+    if (!quit_ && virtual_size() != stream_size_) {
+        // 这里是在调用方的线程里，重开放到下一次截图时做
+        restart_pending_ = true;
+    }
+}
+
+bool MinicapStream::start_stream()
+{
+    LogFunc;
+
     uint32_t width = screencap_helper_.get_w();
     uint32_t height = screencap_helper_.get_h();
+    stream_size_ = virtual_size();
+    restart_pending_ = false;
 
-    process_handle_ = binary_->invoke_bin(MAA_FMT::format("-P {}x{}@{}x{}/{}", width, height, width, height, 0));
+    process_handle_ = binary_->invoke_bin(projection());
 
     if (!process_handle_) {
         LogError << "invoke screencap failed";
@@ -92,10 +108,11 @@ bool MinicapStream::init(int swidth, int sheight)
         return false;
     }
 
-    if (header.real_width != width || header.real_height != height || header.virt_width != width ||
-        header.virt_height != height) {
+    if (header.real_width != width || header.real_height != height) {
         return false;
     }
+    // minicap 可能会为了保持比例调整 virtual size，以它报上来的为准
+    screencap_helper_.set_frame_size(header.virt_width, header.virt_height);
 
     if (!take_out(nullptr, header.size - sizeof(header))) {
         LogError << "take_out header failed";
@@ -108,14 +125,61 @@ bool MinicapStream::init(int swidth, int sheight)
     return true;
 }
 
+void MinicapStream::stop_stream()
+{
+    quit_ = true;
+    if (pull_thread_.joinable()) {
+        pull_thread_.join();
+    }
+
+    stream_handle_ = nullptr;
+    process_handle_ = nullptr;
+
+    std::unique_lock<std::mutex> locker(mutex_);
+    jpeg_.clear();
+    decoded_ = cv::Mat();
+}
+
 std::optional<cv::Mat> MinicapStream::screencap()
 {
+    if (restart_pending_) {
+        auto [virt_width, virt_height] = virtual_size();
+        LogInfo << "virtual size changed, restart minicap" << VAR(virt_width) << VAR(virt_height);
+        stop_stream();
+        if (!start_stream()) {
+            LogError << "restart minicap failed";
+            return std::nullopt;
+        }
+    }
+
     std::unique_lock<std::mutex> locker(mutex_);
 
     using namespace std::chrono_literals;
-    cond_.wait_for(locker, 2s); // 等下一帧
+    uint64_t prev_seq = jpeg_seq_;
+    cond_.wait_for(locker, 2s, [&]() { return jpeg_seq_ != prev_seq; }); // 等下一帧
+
+    if (jpeg_.empty()) {
+        return std::nullopt;
+    }
+    if (decoded_seq_ == jpeg_seq_ && !decoded_.empty()) {
+        return decoded_;
+    }
 
-    return image_.empty() ? std::nullopt : std::make_optional(image_.clone());
+    uint64_t seq = jpeg_seq_;
+    std::string jpeg = jpeg_;
+    LogDebug << VAR(seq) << VAR(jpeg.size()) << "age" << duration_since(jpeg_time_);
+    locker.unlock();
+
+    auto img_opt = screencap_helper_.decode_jpg(jpeg);
+    if (!img_opt || img_opt->empty()) {
+        LogError << "decode jpg failed";
+        return std::nullopt;
+    }
+
+    locker.lock();
+    decoded_seq_ = seq;
+    decoded_ = *img_opt;
+    return img_opt;
 }
 
 bool MinicapStream::read_until(std::string& buffer, size_t size)
@@ -151,34 +215,30 @@ void MinicapStream::working_thread()
 {
     LogFunc;
 
+    std::string buffer;
     while (!quit_) {
+        buffer.clear();
+
         uint32_t size = 0;
         if (!take_out(&size, 4)) {
             LogError << "take_out size failed";
             std::unique_lock<std::mutex> locker(mutex_);
-            image_ = cv::Mat();
+            jpeg_.clear();
             continue;
         }
 
-        std::string buffer;
         if (!read_until(buffer, size)) {
             LogError << "read_until size failed";
             std::unique_lock<std::mutex> locker(mutex_);
-            image_ = cv::Mat();
-            continue;
-        }
-
-        auto img_opt = screencap_helper_.decode_jpg(buffer);
-
-        if (!img_opt || img_opt->empty()) {
-            LogError << "decode jpg failed";
-            std::unique_lock<std::mutex> locker(mutex_);
-            image_ = cv::Mat();
+            jpeg_.clear();
             continue;
         }
 
+        // 不在这里解码，没人要的帧直接被下一帧覆盖掉
         std::unique_lock<std::mutex> locker(mutex_);
-        image_ = std::move(*img_opt);
+        jpeg_.swap(buffer);
+        ++jpeg_seq_;
+        jpeg_time_ = std::chrono::steady_clock::now();
         cond_.notify_all();
     }
 }
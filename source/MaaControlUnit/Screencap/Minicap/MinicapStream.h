@@ -17,10 +17,13 @@ public: // from UnitBase
 
 public: // from ScreencapAPI
     virtual bool init(int swidth, int sheight) override;
+    virtual void set_target_size(int width, int height) override;
 
     virtual std::optional<cv::Mat> screencap() override;
 
 private:
+    bool start_stream();
+    void stop_stream();
     bool read_until(std::string& buffer, size_t size);
     bool take_out(void* out, size_t size);
     void working_thread();
@@ -29,12 +32,21 @@ private:
 
     bool quit_ = true;
     std::mutex mutex_;
-    cv::Mat image_;
+    // 拉流线程只存最新一帧的 jpeg，有人要的时候才解码
+    std::string jpeg_;
+    uint64_t jpeg_seq_ = 0;
+    std::chrono::steady_clock::time_point jpeg_time_;
+    cv::Mat decoded_;
+    uint64_t decoded_seq_ = 0;
     std::condition_variable cond_;
     std::thread pull_thread_;
 
     std::shared_ptr<IOHandler> process_handle_;
     std::shared_ptr<IOHandler> stream_handle_;
+
+    // 当前这条流的 virtual size，目标大小变了要重开
+    std::pair<int, int> stream_size_;
+    bool restart_pending_ = false;
 };
 
 MAA_CTRL_UNIT_NS_END
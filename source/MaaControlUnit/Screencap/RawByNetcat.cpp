@@ -59,15 +59,28 @@ std::optional<cv::Mat> ScreencapRawByNetcat::screencap()
     }
 
     merge_replacement({ { "{NETCAT_ADDRESS}", netcat_address_ }, { "{NETCAT_PORT}", std::to_string(netcat_port_) } });
+
+    // 大小是已知的，直接收进预先分配好的 buffer
+    size_t limit = screencap_helper_.raw_size_limit();
+    if (raw_buffer_size_ != limit) {
+        raw_buffer_.reset(new char[limit]);
+        raw_buffer_size_ = limit;
+    }
+
     constexpr int kTimeout = 2000; // netcat 能用的时候一般都很快，但连不上的时候会一直卡着，所以超时设短一点
-    auto cmd_ret = command(screencap_raw_by_netcat_argv_.gen(argv_replace_), true, kTimeout);
+    auto received = command_to_buffer(screencap_raw_by_netcat_argv_.gen(argv_replace_),
+                                      std::span<char>(raw_buffer_.get(), raw_buffer_size_), kTimeout);
 
-    if (!cmd_ret) {
+    if (!received) {
+        return std::nullopt;
+    }
+    if (*received == raw_buffer_size_) {
+        LogError << "raw data is larger than expected" << VAR(raw_buffer_size_);
         return std::nullopt;
     }
 
-    return screencap_helper_.process_data(
-        cmd_ret.value(), std::bind(&ScreencapHelper::decode_raw, &screencap_helper_, std::placeholders::_1));
+    // socket 里是原始字节，不存在换行被转换的问题，不需要 process_data
+    return screencap_helper_.decode_raw(std::string_view(raw_buffer_.get(), *received));
 }
 
 std::optional<std::string> ScreencapRawByNetcat::request_netcat_address()
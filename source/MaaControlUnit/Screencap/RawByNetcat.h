@@ -28,6 +28,10 @@ private:
 
     std::string netcat_address_;
     uint16_t netcat_port_ = 0;
+
+    // 每帧复用，不清零
+    std::unique_ptr<char[]> raw_buffer_;
+    size_t raw_buffer_size_ = 0;
 };
 
 MAA_CTRL_UNIT_NS_END
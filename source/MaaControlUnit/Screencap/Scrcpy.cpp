@@ -0,0 +1,38 @@
+#include "Scrcpy.h"
+
+#include "Utils/Logger.h"
+
+MAA_CTRL_UNIT_NS_BEGIN
+
+bool ScreencapScrcpy::parse(const json::value& config)
+{
+    return server_->parse(config);
+}
+
+bool ScreencapScrcpy::init(int swidth, int sheight)
+{
+    LogFunc;
+
+    ScreencapBase::set_wh(swidth, sheight);
+    return server_->start(swidth, sheight);
+}
+
+void ScreencapScrcpy::set_wh(int swidth, int sheight)
+{
+    ScreencapBase::set_wh(swidth, sheight);
+    server_->start(swidth, sheight);
+}
+
+std::optional<cv::Mat> ScreencapScrcpy::screencap()
+{
+    using namespace std::chrono_literals;
+
+    // 出来的是视频大小（宽高对齐到 8），剩下的缩放交给 ControllerMgr
+    auto frame = server_->latest_frame(1s);
+    if (!frame) {
+        LogError << "no frame from scrcpy";
+    }
+    return frame;
+}
+
+MAA_CTRL_UNIT_NS_END
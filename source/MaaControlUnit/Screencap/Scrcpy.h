@@ -0,0 +1,32 @@
+#pragma once
+
+#include "UnitBase.h"
+
+#include "Invoke/ScrcpyServer.h"
+
+MAA_CTRL_UNIT_NS_BEGIN
+
+class ScreencapScrcpy : public ScreencapBase
+{
+public:
+    explicit ScreencapScrcpy(std::shared_ptr<ScrcpyServer> server) : server_(std::move(server))
+    {
+        children_.emplace_back(server_);
+    }
+    virtual ~ScreencapScrcpy() override = default;
+
+public: // from UnitBase
+    virtual bool parse(const json::value& config) override;
+
+public: // from ScreencapAPI
+    virtual bool init(int swidth, int sheight) override;
+    virtual void deinit() override {}
+    virtual void set_wh(int swidth, int sheight) override;
+
+    virtual std::optional<cv::Mat> screencap() override;
+
+private:
+    std::shared_ptr<ScrcpyServer> server_;
+};
+
+MAA_CTRL_UNIT_NS_END
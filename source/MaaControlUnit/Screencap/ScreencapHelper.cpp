@@ -1,16 +1,12 @@
 #include "ScreencapHelper.h"
 
 #include "Utils/Logger.h"
+#include "Utils/MatPool.hpp"
 #include "Utils/NoWarningCV.hpp"
 
-#ifdef _MSC_VER
-#pragma warning(push)
-#pragma warning(disable : 4068)
-#endif
-#include <gzip/decompress.hpp>
-#ifdef _MSC_VER
-#pragma warning(pop)
-#endif
+#include <array>
+
+#include <zlib.h>
 
 MAA_CTRL_UNIT_NS_BEGIN
 
@@ -18,6 +14,20 @@ void ScreencapHelper::set_wh(int w, int h)
 {
     width_ = w;
     height_ = h;
+    frame_width_ = w;
+    frame_height_ = h;
+}
+
+void ScreencapHelper::set_target_size(int w, int h)
+{
+    target_width_ = w;
+    target_height_ = h;
+}
+
+void ScreencapHelper::set_frame_size(int w, int h)
+{
+    frame_width_ = w;
+    frame_height_ = h;
 }
 
 std::optional<cv::Mat> ScreencapHelper::process_data(
@@ -91,7 +101,7 @@ std::optional<cv::Mat> ScreencapHelper::process_data(
     return res;
 }
 
-std::optional<cv::Mat> ScreencapHelper::decode_raw(const std::string& buffer)
+std::optional<cv::Mat> ScreencapHelper::decode_raw(std::string_view buffer)
 {
     if (buffer.size() < 8) {
         return std::nullopt;
@@ -102,9 +112,9 @@ std::optional<cv::Mat> ScreencapHelper::decode_raw(const std::string& buffer)
     memcpy(&im_width, data, 4);
     memcpy(&im_height, data + 4, 4);
 
-    if (int(im_width) != width_ || int(im_height) != height_) {
+    if (!is_expected_size(im_width, im_height)) {
         LogError << "screencap size image" << VAR(im_width) << VAR(im_height) << "don't match" << VAR(width_)
-                 << VAR(height_);
+                 << VAR(height_) << VAR(target_width_) << VAR(target_height_);
         return std::nullopt;
     }
 
@@ -117,23 +127,141 @@ std::optional<cv::Mat> ScreencapHelper::decode_raw(const std::string& buffer)
     size_t header_size = buffer.size() - size;
     const uint8_t* im_data = data + header_size;
 
-    cv::Mat temp(height_, width_, CV_8UC4, const_cast<uint8_t*>(im_data));
+    cv::Mat temp(im_height, im_width, CV_8UC4, const_cast<uint8_t*>(im_data));
     if (temp.empty()) {
         return std::nullopt;
     }
 
-    const auto& br = *(temp.end<cv::Vec4b>() - 1);
-    if (br[3] != 255) { // only check alpha
+    if (!check_alpha(temp)) {
         return std::nullopt;
     }
-    cv::cvtColor(temp, temp, cv::COLOR_RGBA2BGR);
-    return temp.clone(); // temp只是引用data, 需要clone确保数据拥有所有权
+
+    // temp只是引用data, 直接转换到池里借来的 Mat 上，省掉一次 clone
+    return rgba_to_bgr(temp);
 }
 
 std::optional<cv::Mat> ScreencapHelper::decode_gzip(const std::string& buffer)
 {
-    auto buf = gzip::decompress(buffer.c_str(), buffer.size());
-    return decode_raw(buf);
+    // gzip 尾部是 CRC32 + 解压后的大小，据此算出 raw 头的长度，头和像素分开解压，像素直接解进图像内存
+    constexpr size_t kGzipMinSize = 18;
+    if (buffer.size() < kGzipMinSize) {
+        return std::nullopt;
+    }
+
+    const uint8_t* tail = reinterpret_cast<const uint8_t*>(buffer.data() + buffer.size() - 4);
+    size_t total = size_t(tail[0]) | size_t(tail[1]) << 8 | size_t(tail[2]) << 16 | size_t(tail[3]) << 24;
+
+    // 可能是整屏，也可能是设备端已经缩到目标大小的
+    int width = width_;
+    int height = height_;
+    auto header_fits = [total](int w, int h) {
+        size_t pixel_size = 4ull * w * h;
+        return total >= pixel_size + 8 && total - pixel_size <= kRawHeaderLimit;
+    };
+    if (!header_fits(width, height)) {
+        width = target_width_;
+        height = target_height_;
+    }
+    if (width <= 0 || height <= 0 || !header_fits(width, height)) {
+        LogError << "unexpected raw size" << VAR(total) << VAR(width_) << VAR(height_);
+        return std::nullopt;
+    }
+    size_t header_size = total - 4ull * width * height;
+
+    z_stream stream {};
+    if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK) {
+        LogError << "inflateInit2 failed";
+        return std::nullopt;
+    }
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(buffer.data()));
+    stream.avail_in = static_cast<uInt>(buffer.size());
+
+    auto inflate_exact = [&stream](void* out, size_t size) -> bool {
+        stream.next_out = static_cast<Bytef*>(out);
+        stream.avail_out = static_cast<uInt>(size);
+        while (stream.avail_out > 0) {
+            int ret = inflate(&stream, Z_NO_FLUSH);
+            if (ret != Z_OK && ret != Z_STREAM_END) {
+                LogError << "inflate failed" << VAR(ret);
+                return false;
+            }
+            if (ret == Z_STREAM_END) {
+                break;
+            }
+        }
+        return stream.avail_out == 0;
+    };
+
+    std::array<uint8_t, kRawHeaderLimit> header {};
+    if (!inflate_exact(header.data(), header_size)) {
+        inflateEnd(&stream);
+        return std::nullopt;
+    }
+
+    uint32_t im_width = 0, im_height = 0;
+    memcpy(&im_width, header.data(), 4);
+    memcpy(&im_height, header.data() + 4, 4);
+    if (int(im_width) != width || int(im_height) != height) {
+        LogError << "screencap size image" << VAR(im_width) << VAR(im_height) << "don't match" << VAR(width)
+                 << VAR(height);
+        inflateEnd(&stream);
+        return std::nullopt;
+    }
+
+    // 不缩放时每解出一段就转一段，转换和解压交替进行，数据还在缓存里
+    const bool scale = need_scale(width, height);
+    cv::Mat rgba = MatPool::get_instance().acquire(height, width, CV_8UC4);
+    cv::Mat dst = scale ? cv::Mat() : MatPool::get_instance().acquire(height, width, CV_8UC3);
+
+    constexpr int kBandRows = 64;
+    bool inflated = true;
+    for (int row = 0; row < height && inflated; row += kBandRows) {
+        int rows = std::min(kBandRows, height - row);
+        inflated = inflate_exact(rgba.ptr(row), 4ull * width * rows);
+        if (inflated && !scale) {
+            cv::Mat dst_band = dst.rowRange(row, row + rows);
+            cv::cvtColor(rgba.rowRange(row, row + rows), dst_band, cv::COLOR_RGBA2BGR);
+        }
+    }
+    inflateEnd(&stream);
+
+    if (!inflated || !check_alpha(rgba)) {
+        return std::nullopt;
+    }
+    return scale ? rgba_to_bgr(rgba) : dst;
+}
+
+bool ScreencapHelper::need_scale(int w, int h) const
+{
+    return target_width_ > 0 && target_height_ > 0 && (target_width_ != w || target_height_ != h);
+}
+
+bool ScreencapHelper::is_expected_size(int w, int h) const
+{
+    return (w == width_ && h == height_) || (target_width_ > 0 && w == target_width_ && h == target_height_);
+}
+
+bool ScreencapHelper::check_alpha(const cv::Mat& rgba)
+{
+    const auto& br = *(rgba.end<cv::Vec4b>() - 1);
+    return br[3] == 255; // only check alpha
+}
+
+cv::Mat ScreencapHelper::rgba_to_bgr(const cv::Mat& rgba)
+{
+    cv::Mat src = rgba;
+
+    // 要缩放的话先在 RGBA 上缩到目标大小再转 BGR，整帧只扫一遍，转换只做在小图上
+    // 插值是逐通道的，和先转 BGR 再缩放结果一致
+    if (need_scale(src.cols, src.rows)) {
+        cv::Mat scaled = MatPool::get_instance().acquire(target_height_, target_width_, CV_8UC4);
+        cv::resize(src, scaled, { target_width_, target_height_ });
+        src = scaled;
+    }
+
+    cv::Mat dst = MatPool::get_instance().acquire(src.rows, src.cols, CV_8UC3);
+    cv::cvtColor(src, dst, cv::COLOR_RGBA2BGR);
+    return dst;
 }
 
 std::optional<cv::Mat> ScreencapHelper::decode_png(const std::string& buffer)
@@ -149,15 +277,50 @@ std::optional<cv::Mat> ScreencapHelper::decode_jpg(const std::string& buffer)
     if (!check_head_tail(buffer, "\xFF\xD8\xFF", "\xFF\xD9")) {
         return std::nullopt;
     }
-    return decode(buffer);
+
+    // libjpeg 能在 DCT 阶段直接按 1/2、1/4、1/8 缩小解码，选不小于目标大小的最大倍数，剩下的缩放量就很小了
+    int factor = jpeg_reduce_factor();
+    switch (factor) {
+    case 8:
+        return decode(buffer, cv::IMREAD_REDUCED_COLOR_8, factor);
+    case 4:
+        return decode(buffer, cv::IMREAD_REDUCED_COLOR_4, factor);
+    case 2:
+        return decode(buffer, cv::IMREAD_REDUCED_COLOR_2, factor);
+    default:
+        return decode(buffer);
+    }
 }
 
 std::optional<cv::Mat> ScreencapHelper::decode(const std::string& buffer)
 {
-    cv::Mat img = cv::imdecode({ buffer.data(), int(buffer.size()) }, cv::IMREAD_COLOR);
+    return decode(buffer, cv::IMREAD_COLOR, 1);
+}
+
+std::optional<cv::Mat> ScreencapHelper::decode(const std::string& buffer, int flags, int reduce_factor)
+{
+    // 一般解出来就是帧的大小（缩小解码时向上取整），先从池里借一块；尺寸不符时 imdecode 会自己重新分配
+    int rows = (frame_height_ + reduce_factor - 1) / reduce_factor;
+    int cols = (frame_width_ + reduce_factor - 1) / reduce_factor;
+    cv::Mat dst = MatPool::get_instance().acquire(rows, cols, CV_8UC3);
+    cv::Mat img = cv::imdecode({ buffer.data(), int(buffer.size()) }, flags, &dst);
     return img.empty() ? std::nullopt : std::make_optional(img);
 }
 
+int ScreencapHelper::jpeg_reduce_factor() const
+{
+    if (!need_scale(frame_width_, frame_height_)) {
+        return 1;
+    }
+
+    for (int factor : { 8, 4, 2 }) {
+        if (frame_width_ / factor >= target_width_ && frame_height_ / factor >= target_height_) {
+            return factor;
+        }
+    }
+    return 1;
+}
+
 bool ScreencapHelper::clean_cr(std::string& buffer)
 {
     if (buffer.size() < 2) {
@@ -3,6 +3,7 @@
 #include <functional>
 #include <optional>
 #include <string>
+#include <string_view>
 
 #include "Conf/Conf.h"
 #include "Utils/NoWarningCVMat.hpp"
@@ -13,12 +14,17 @@ class ScreencapHelper
 {
 public:
     void set_wh(int w, int h);
+    void set_target_size(int w, int h);
+    // 设备端已经缩放过时，实际收到的帧的大小；set_wh 会重置为屏幕大小
+    void set_frame_size(int w, int h);
     int get_w() const { return width_; }
     int get_h() const { return height_; }
+    // raw 截图（screencap 不带 -p）最多的字节数，头部 12 或 16 字节，多留一些余量
+    size_t raw_size_limit() const { return kRawHeaderLimit + 4ull * width_ * height_; }
 
     std::optional<cv::Mat> process_data(std::string& buffer,
                                         std::function<std::optional<cv::Mat>(const std::string& buffer)> decoder);
-    std::optional<cv::Mat> decode_raw(const std::string& buffer);
+    std::optional<cv::Mat> decode_raw(std::string_view buffer);
     std::optional<cv::Mat> decode_gzip(const std::string& buffer);
     std::optional<cv::Mat> decode_png(const std::string& buffer);
     std::optional<cv::Mat> decode_jpg(const std::string& buffer);
@@ -26,10 +32,22 @@ public:
     static bool clean_cr(std::string& buffer);
 
 protected:
+    static constexpr size_t kRawHeaderLimit = 4096;
+
     int width_ = 0;
     int height_ = 0;
+    int target_width_ = 0;
+    int target_height_ = 0;
+    int frame_width_ = 0;
+    int frame_height_ = 0;
 
 private:
+    bool need_scale(int w, int h) const;
+    bool is_expected_size(int w, int h) const;
+    int jpeg_reduce_factor() const;
+    std::optional<cv::Mat> decode(const std::string& buffer, int flags, int reduce_factor);
+    static bool check_alpha(const cv::Mat& rgba);
+    cv::Mat rgba_to_bgr(const cv::Mat& rgba);
     bool check_head_tail(std::string_view input, std::string_view head, std::string_view tail);
 
     enum class EndOfLine
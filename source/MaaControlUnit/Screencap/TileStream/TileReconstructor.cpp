@@ -0,0 +1,127 @@
+#include "TileReconstructor.h"
+
+#include <cstring>
+
+#include <zlib.h>
+
+#include "Utils/Logger.h"
+#include "Utils/NoWarningCV.hpp"
+
+MAA_CTRL_UNIT_NS_BEGIN
+
+bool TileReconstructor::reset(const TileStreamHeader& header)
+{
+    LogFunc << VAR(header.width) << VAR(header.height) << VAR(header.tile_width) << VAR(header.tile_height);
+
+    if (header.width == 0 || header.height == 0 || header.tile_width == 0 || header.tile_height == 0) {
+        LogError << "invalid header";
+        return false;
+    }
+
+    int width = static_cast<int>(header.width);
+    int height = static_cast<int>(header.height);
+    tile_width_ = static_cast<int>(header.tile_width);
+    tile_height_ = static_cast<int>(header.tile_height);
+    columns_ = (width + tile_width_ - 1) / tile_width_;
+    rows_ = (height + tile_height_ - 1) / tile_height_;
+
+    has_keyframe_ = false;
+    image_.create(height, width, CV_8UC3);
+    changed_.clear();
+    return true;
+}
+
+bool TileReconstructor::apply(const TileFrameHeader& frame, std::string_view body)
+{
+    if (image_.empty()) {
+        LogError << "not reset yet";
+        return false;
+    }
+
+    const bool keyframe = frame.type == TileFrameHeader::Keyframe;
+    if (!keyframe && !has_keyframe_) {
+        // 中途接上的流，等关键帧
+        LogDebug << "waiting for keyframe";
+        return false;
+    }
+    if (keyframe && frame.tile_count != static_cast<uint32_t>(columns_ * rows_)) {
+        LogError << "keyframe is incomplete" << VAR(frame.tile_count) << VAR(columns_) << VAR(rows_);
+        return false;
+    }
+
+    changed_.clear();
+
+    size_t offset = 0;
+    for (uint32_t i = 0; i < frame.tile_count; ++i) {
+        TileHeader tile;
+        if (body.size() - offset < sizeof(tile)) {
+            LogError << "tile header out of range" << VAR(i) << VAR(offset) << VAR(body.size());
+            has_keyframe_ = false;
+            return false;
+        }
+        memcpy(&tile, body.data() + offset, sizeof(tile));
+        offset += sizeof(tile);
+
+        if (tile.column >= columns_ || tile.row >= rows_ || body.size() - offset < tile.size) {
+            LogError << "invalid tile" << VAR(tile.column) << VAR(tile.row) << VAR(tile.size);
+            has_keyframe_ = false;
+            return false;
+        }
+
+        cv::Rect rect = tile_rect(tile.column, tile.row);
+        const char* pixels = decode_tile(frame.codec, body.substr(offset, tile.size), 4ull * rect.area());
+        if (!pixels) {
+            // 这一帧已经改了一半，只能等下一个关键帧
+            has_keyframe_ = false;
+            return false;
+        }
+        offset += tile.size;
+
+        cv::Mat rgba(rect.height, rect.width, CV_8UC4, const_cast<char*>(pixels));
+        cv::Mat dst = image_(rect);
+        cv::cvtColor(rgba, dst, cv::COLOR_RGBA2BGR);
+        changed_.emplace_back(rect);
+    }
+
+    if (keyframe) {
+        has_keyframe_ = true;
+    }
+    return true;
+}
+
+cv::Rect TileReconstructor::tile_rect(int column, int row) const
+{
+    int x = column * tile_width_;
+    int y = row * tile_height_;
+    return { x, y, std::min(tile_width_, image_.cols - x), std::min(tile_height_, image_.rows - y) };
+}
+
+const char* TileReconstructor::decode_tile(uint8_t codec, std::string_view data, size_t expect)
+{
+    switch (codec) {
+    case TileFrameHeader::Raw:
+        if (data.size() != expect) {
+            LogError << "raw tile size mismatch" << VAR(data.size()) << VAR(expect);
+            return nullptr;
+        }
+        return data.data();
+
+    case TileFrameHeader::Deflate: {
+        tile_buffer_.resize(expect);
+        uLongf dest_len = static_cast<uLongf>(expect);
+        int ret = uncompress(reinterpret_cast<Bytef*>(tile_buffer_.data()), &dest_len,
+                             reinterpret_cast<const Bytef*>(data.data()), static_cast<uLong>(data.size()));
+        if (ret != Z_OK || dest_len != expect) {
+            LogError << "uncompress tile failed" << VAR(ret) << VAR(dest_len) << VAR(expect);
+            return nullptr;
+        }
+        return tile_buffer_.data();
+    }
+
+    default:
+        LogError << "unknown codec" << VAR(static_cast<int>(codec));
+        return nullptr;
+    }
+}
+
+MAA_CTRL_UNIT_NS_END
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "TileStreamDef.h"
+#include "Utils/NoWarningCVMat.hpp"
+
+MAA_CTRL_UNIT_NS_BEGIN
+
+// 把 tile 流还原成整帧，图像缓冲一直复用，每帧只覆盖变了的 tile
+class TileReconstructor
+{
+public:
+    bool reset(const TileStreamHeader& header);
+    bool apply(const TileFrameHeader& frame, std::string_view body);
+
+    bool ready() const { return has_keyframe_; }
+    // BGR，下一次 apply 会被改写，要留着得自己拷
+    const cv::Mat& image() const { return image_; }
+    // 上一次 apply 改写了的区域
+    const std::vector<cv::Rect>& changed() const { return changed_; }
+
+private:
+    cv::Rect tile_rect(int column, int row) const;
+    // 返回解出来的 RGBA 数据，不压缩的直接指向 data
+    const char* decode_tile(uint8_t codec, std::string_view data, size_t expect);
+
+    int tile_width_ = 0;
+    int tile_height_ = 0;
+    int columns_ = 0;
+    int rows_ = 0;
+
+    bool has_keyframe_ = false;
+    cv::Mat image_;
+    std::string tile_buffer_;
+    std::vector<cv::Rect> changed_;
+};
+
+MAA_CTRL_UNIT_NS_END
@@ -0,0 +1,226 @@
+#include "TileStream.h"
+
+#include <cstring>
+
+#include "Utils/Logger.h"
+#include "Utils/MatPool.hpp"
+#include "Utils/NoWarningCV.hpp"
+
+MAA_CTRL_UNIT_NS_BEGIN
+
+ScreencapTileStream::~ScreencapTileStream()
+{
+    deinit();
+}
+
+bool ScreencapTileStream::parse(const json::value& config)
+{
+    auto topt = config.find<json::object>("tile_stream");
+    if (topt) {
+        tile_size_ = topt->get("tile_size", tile_size_);
+        keyframe_interval_ = topt->get("keyframe_interval", keyframe_interval_);
+    }
+
+    // 默认配置里没有 agent 的命令，没配就是不用这个方式，不算错误
+    auto copt = config.find<json::object>("command");
+    if (!copt || !copt->contains("ScreencapTileStream")) {
+        LogDebug << "ScreencapTileStream command not configured";
+        screencap_tile_stream_argv_.argv.clear();
+        return false;
+    }
+
+    return parse_argv("ScreencapTileStream", config, screencap_tile_stream_argv_);
+}
+
+bool ScreencapTileStream::init(int swidth, int sheight)
+{
+    LogFunc;
+
+    if (!io_ptr_) {
+        LogError << "io_ptr is nullptr";
+        return false;
+    }
+
+    if (screencap_tile_stream_argv_.argv.empty()) {
+        LogDebug << "ScreencapTileStream command not configured";
+        return false;
+    }
+
+    if (tile_size_ <= 0) {
+        LogError << "invalid tile size" << VAR(tile_size_);
+        return false;
+    }
+
+    deinit();
+    set_wh(swidth, sheight);
+
+    merge_replacement({ { "{TILE_SIZE}", std::to_string(tile_size_) },
+                        { "{KEYFRAME_INTERVAL}", std::to_string(keyframe_interval_) } });
+    stream_handle_ = io_ptr_->interactive_shell(screencap_tile_stream_argv_.gen(argv_replace_), false);
+    if (!stream_handle_) {
+        LogError << "invoke tile stream agent failed";
+        return false;
+    }
+
+    TileStreamHeader header;
+    if (!read_exact(&header, sizeof(header))) {
+        LogError << "read header failed";
+        return false;
+    }
+
+    LogInfo << VAR(header.magic) << VAR(header.size) << VAR(header.width) << VAR(header.height)
+            << VAR(header.tile_width) << VAR(header.tile_height);
+
+    if (header.magic != TileStreamHeader::kMagic || header.size < sizeof(header)) {
+        LogError << "not a tile stream";
+        return false;
+    }
+    if (static_cast<int>(header.width) != swidth || static_cast<int>(header.height) != sheight) {
+        LogError << "size mismatch" << VAR(swidth) << VAR(sheight);
+        return false;
+    }
+    if (header.size > sizeof(header)) {
+        std::string ignored(header.size - sizeof(header), '\0');
+        if (!read_exact(ignored.data(), ignored.size())) {
+            return false;
+        }
+    }
+
+    if (!reconstructor_.reset(header)) {
+        return false;
+    }
+
+    quit_ = false;
+    pull_thread_ = std::thread(&ScreencapTileStream::working_thread, this);
+    return true;
+}
+
+void ScreencapTileStream::deinit()
+{
+    quit_ = true;
+    if (pull_thread_.joinable()) {
+        pull_thread_.join();
+    }
+    stream_handle_ = nullptr;
+
+    std::unique_lock<std::mutex> locker(mutex_);
+    pending_changed_.clear();
+    changed_.clear();
+}
+
+std::optional<cv::Mat> ScreencapTileStream::screencap()
+{
+    if (quit_) {
+        return std::nullopt;
+    }
+
+    std::unique_lock<std::mutex> locker(mutex_);
+
+    using namespace std::chrono_literals;
+    uint64_t prev_seq = frame_seq_;
+    cond_.wait_for(locker, 2s, [&]() { return frame_seq_ != prev_seq || quit_; }); // 等下一帧
+
+    // 没变化 agent 也会发空帧，等不到就是流断了，不能把旧图当新的交出去
+    if (quit_) {
+        LogError << "tile stream stopped";
+        return std::nullopt;
+    }
+    if (frame_seq_ == prev_seq) {
+        LogError << "no new frame";
+        return std::nullopt;
+    }
+
+    if (!reconstructor_.ready()) {
+        LogError << "no keyframe yet";
+        return std::nullopt;
+    }
+
+    // 重建的缓冲会被接着改写，交出去的得是一份拷贝
+    const cv::Mat& image = reconstructor_.image();
+    cv::Mat result = MatPool::get_instance().acquire(image.rows, image.cols, image.type());
+    image.copyTo(result);
+
+    changed_.swap(pending_changed_);
+    pending_changed_.clear();
+    LogDebug << VAR(frame_seq_) << VAR(changed_.size());
+
+    return result;
+}
+
+std::optional<std::vector<cv::Rect>> ScreencapTileStream::changed_regions() const
+{
+    if (quit_) {
+        return std::nullopt;
+    }
+
+    std::unique_lock<std::mutex> locker(mutex_);
+    return changed_;
+}
+
+bool ScreencapTileStream::read_exact(void* out, size_t size)
+{
+    // 读到 eof 会立刻返回，读不满就是 agent 退了或者超时了，流也已经错位，不再重试
+    auto ret = stream_handle_->read(5, size);
+    if (ret.size() != size) {
+        LogError << "short read" << VAR(size) << VAR(ret.size());
+        return false;
+    }
+    memcpy(out, ret.data(), size);
+    return true;
+}
+
+void ScreencapTileStream::stop_pulling()
+{
+    std::unique_lock<std::mutex> locker(mutex_);
+    reconstructor_ = TileReconstructor();
+    quit_ = true;
+    cond_.notify_all();
+}
+
+void ScreencapTileStream::working_thread()
+{
+    LogFunc;
+
+    // 关键帧不压缩时最大，再多出来的只能是流已经错位了
+    const int width = screencap_helper_.get_w();
+    const int height = screencap_helper_.get_h();
+    constexpr size_t kPendingLimit = 1024;
+    const size_t frame_limit = 4ull * width * height + sizeof(TileHeader) * (1ull * width * height);
+
+    std::string body;
+    while (!quit_) {
+        TileFrameHeader frame;
+        if (!read_exact(&frame, sizeof(frame))) {
+            LogError << "read frame header failed";
+            stop_pulling();
+            break;
+        }
+        if (frame.size > frame_limit) {
+            LogError << "frame too large, stream is broken" << VAR(frame.size) << VAR(frame_limit);
+            stop_pulling();
+            break;
+        }
+
+        body.resize(frame.size);
+        if (!read_exact(body.data(), body.size())) {
+            LogError << "read frame body failed" << VAR(frame.size);
+            stop_pulling();
+            break;
+        }
+
+        std::unique_lock<std::mutex> locker(mutex_);
+        if (!reconstructor_.apply(frame, body)) {
+            continue;
+        }
+        const auto& changed = reconstructor_.changed();
+        pending_changed_.insert(pending_changed_.end(), changed.begin(), changed.end());
+        if (pending_changed_.size() > kPendingLimit) {
+            // 很久没人取了，当作整屏都变了
+            pending_changed_ = { cv::Rect(0, 0, width, height) };
+        }
+        ++frame_seq_;
+        cond_.notify_all();
+    }
+}
+
+MAA_CTRL_UNIT_NS_END
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "UnitBase.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "TileReconstructor.h"
+
+MAA_CTRL_UNIT_NS_BEGIN
+
+// 设备端 agent 只发变了的 tile（见 TileStreamDef.h），agent 由配置里的 ScreencapTileStream 命令启动
+class ScreencapTileStream : public ScreencapBase
+{
+public:
+    virtual ~ScreencapTileStream() override;
+
+public: // from UnitBase
+    virtual bool parse(const json::value& config) override;
+
+public: // from ScreencapAPI
+    virtual bool init(int swidth, int sheight) override;
+    virtual void deinit() override;
+
+    virtual std::optional<cv::Mat> screencap() override;
+    virtual std::optional<std::vector<cv::Rect>> changed_regions() const override;
+
+private:
+    bool read_exact(void* out, size_t size);
+    // 流出错了，停掉拉流，等着的 screencap 立刻返回
+    void stop_pulling();
+    void working_thread();
+
+    Argv screencap_tile_stream_argv_;
+    int tile_size_ = 64;
+    int keyframe_interval_ = 60;
+
+    std::shared_ptr<IOHandler> stream_handle_;
+
+    std::atomic_bool quit_ = true;
+    mutable std::mutex mutex_;
+    std::condition_variable cond_;
+    std::thread pull_thread_;
+    TileReconstructor reconstructor_;
+    uint64_t frame_seq_ = 0;
+    std::vector<cv::Rect> pending_changed_; // 拉流线程攒下的，screencap 时交出去
+    std::vector<cv::Rect> changed_;
+};
+
+MAA_CTRL_UNIT_NS_END
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Conf/Conf.h"
+
+#include <cstdint>
+
+MAA_CTRL_UNIT_NS_BEGIN
+
+// 设备端 agent 输出到 stdout 的流，全部小端
+// 开头一个 TileStreamHeader，之后每截一次一帧：TileFrameHeader，跟着 tile_count 个 TileHeader + 数据
+// 没有变化也要发一个 tile_count 为 0 的帧，host 靠它知道画面是新的
+// 每个 tile 的数据是 RGBA，按 codec 压缩；右边和下边的 tile 可能不满
+
+#pragma pack(push, 1)
+
+struct TileStreamHeader
+{
+    static constexpr uint32_t kMagic = 0x3153544D; // "MTS1"
+
+    uint32_t magic = 0;
+    uint32_t size = 0; // 整个头的大小，以后加字段时旧的 host 也能跳过
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t tile_width = 0;
+    uint32_t tile_height = 0;
+};
+
+struct TileFrameHeader
+{
+    enum Type : uint8_t
+    {
+        Keyframe = 0, // 所有 tile 都在
+        Delta = 1,    // 只有变了的 tile
+    };
+
+    enum Codec : uint8_t
+    {
+        Raw = 0,
+        Deflate = 1, // zlib 格式
+    };
+
+    uint32_t size = 0; // 之后本帧所有 TileHeader + 数据的字节数
+    uint8_t type = Keyframe;
+    uint8_t codec = Raw;
+    uint16_t reserved = 0;
+    uint32_t tile_count = 0;
+};
+
+struct TileHeader
+{
+    uint16_t column = 0;
+    uint16_t row = 0;
+    uint32_t size = 0;
+};
+
+#pragma pack(pop)
+
+MAA_CTRL_UNIT_NS_END
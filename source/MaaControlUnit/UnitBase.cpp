@@ -90,4 +90,47 @@ std::optional<std::string> UnitBase::command(const Argv::value& cmd, bool recv_b
     return recv_by_socket ? sock_data : pipe_data;
 }
 
+std::optional<size_t> UnitBase::command_to_buffer(const Argv::value& cmd, std::span<char> sock_buffer,
+                                                 int64_t timeout)
+{
+    if (!io_ptr_) {
+        LogError << "io_ptr is nullptr";
+        return std::nullopt;
+    }
+
+    auto start_time = std::chrono::steady_clock::now();
+
+    size_t sock_received = 0;
+    int ret = io_ptr_->call_command_to_buffer(cmd, sock_buffer, sock_received, timeout);
+
+    auto duration = duration_since(start_time);
+
+    std::string scmd = json::array(cmd).to_string();
+    LogDebug << VAR(scmd) << VAR(ret) << VAR(sock_buffer.size()) << VAR(sock_received) << VAR(duration);
+
+    if (ret != 0) {
+        LogError << "call_command_to_buffer failed" << VAR(cmd) << VAR(ret);
+        return std::nullopt;
+    }
+
+    return sock_received;
+}
+
+bool TouchInputBase::gesture(const std::vector<TouchEvent>& events)
+{
+    LogFunc << VAR(events.size());
+
+    return play_touch_events(events, [&](const TouchEvent& event) {
+        switch (event.type) {
+        case TouchEvent::Type::Down:
+            return touch_down(event.contact, event.x, event.y, event.pressure);
+        case TouchEvent::Type::Move:
+            return touch_move(event.contact, event.x, event.y, event.pressure);
+        case TouchEvent::Type::Up:
+            return touch_up(event.contact);
+        }
+        return false;
+    });
+}
+
 MAA_CTRL_UNIT_NS_END
@@ -27,6 +27,9 @@ protected:
     static bool parse_argv(const std::string& key, const json::value& config, /*out*/ Argv& argv);
 
     std::optional<std::string> command(const Argv::value& cmd, bool recv_by_socket = false, int64_t timeout = 20000);
+    // 返回 socket 实际收到的字节数
+    std::optional<size_t> command_to_buffer(const Argv::value& cmd, std::span<char> sock_buffer,
+                                            int64_t timeout = 20000);
 
 protected:
     std::shared_ptr<PlatformIO> io_ptr_ = nullptr;
@@ -65,6 +68,22 @@ public:
 
 public:
     virtual void set_wh(int swidth, int sheight) override { screencap_helper_.set_wh(swidth, sheight); }
+    virtual void set_target_size(int width, int height) override
+    {
+        screencap_helper_.set_target_size(width, height);
+
+        // 给能在设备端缩放的截图命令用，没有目标大小时就是整屏
+        bool has_target = width > 0 && height > 0;
+        merge_replacement({ { "{TARGET_WIDTH}", std::to_string(has_target ? width : screencap_helper_.get_w()) },
+                            { "{TARGET_HEIGHT}", std::to_string(has_target ? height : screencap_helper_.get_h()) } });
+    }
+    // 只有一种方式，没什么可选的
+    virtual void set_preferred_methods(std::vector<std::string> methods) override { std::ignore = methods; }
+    virtual std::vector<std::string> get_preferred_methods() const override { return {}; }
+    virtual std::string get_current_method() const override { return {}; }
+    virtual std::vector<ScreencapMethodStats> get_method_stats() const override { return {}; }
+    // 整帧传输的都不知道哪里变了
+    virtual std::optional<std::vector<cv::Rect>> changed_regions() const override { return std::nullopt; }
 
 protected:
     ScreencapHelper screencap_helper_;
@@ -74,6 +93,10 @@ class TouchInputBase : public TouchInputAPI, virtual public UnitBase
 {
 public:
     virtual ~TouchInputBase() override = default;
+
+public: // from TouchInputAPI
+    // 默认逐个调 touch_down / touch_move / touch_up，能批量写的自己重写
+    virtual bool gesture(const std::vector<TouchEvent>& events) override;
 };
 
 class KeyInputBase : public KeyInputAPI, virtual public UnitBase
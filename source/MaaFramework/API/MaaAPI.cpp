@@ -8,6 +8,9 @@
 #include "Controller/AdbController.h"
 #include "Controller/CustomController.h"
 #include "Controller/CustomThriftController.h"
+#include "Controller/FileController.h"
+#include "Controller/ReplayController.h"
+#include "Controller/X11Controller.h"
 #include "Instance/InstanceMgr.h"
 #include "Option/GlobalOptionMgr.h"
 #include "Resource/ResourceMgr.h"
@@ -348,6 +351,75 @@ MaaControllerHandle MaaAdbControllerCreate(MaaStringView adb_path, MaaStringView
     return new MAA_CTRL_NS::AdbController(adb_path, address, std::move(unit_mgr), callback, callback_arg);
 }
 
+MaaControllerHandle MaaX11ControllerCreate(MaaStringView display, MaaStringView config,
+                                           MaaControllerCallback callback, MaaCallbackTransparentArg callback_arg)
+{
+    LogFunc << VAR(display) << VAR(config) << VAR_VOIDP(callback) << VAR_VOIDP(callback_arg);
+
+#ifdef WITH_X11
+
+    try {
+        return new MAA_CTRL_NS::X11Controller(display, config, callback, callback_arg);
+    }
+    catch (const std::exception& e) {
+        LogError << "Failed to create X11 controller: " << e.what();
+        return nullptr;
+    }
+
+#else
+
+#pragma message("The build without X11")
+
+    LogError << "The build without X11";
+    return nullptr;
+
+#endif // WITH_X11
+}
+
+MaaControllerHandle MaaReplayControllerCreate(MaaStringView config, MaaControllerCallback callback,
+                                              MaaCallbackTransparentArg callback_arg)
+{
+    LogFunc << VAR(config) << VAR_VOIDP(callback) << VAR_VOIDP(callback_arg);
+
+    try {
+        return new MAA_CTRL_NS::ReplayController(config, callback, callback_arg);
+    }
+    catch (const std::exception& e) {
+        LogError << "Failed to create replay controller: " << e.what();
+        return nullptr;
+    }
+}
+
+MaaControllerHandle MaaVideoControllerCreate(MaaStringView path, MaaStringView config, MaaControllerCallback callback,
+                                             MaaCallbackTransparentArg callback_arg)
+{
+    LogFunc << VAR(path) << VAR(config) << VAR_VOIDP(callback) << VAR_VOIDP(callback_arg);
+
+    try {
+        return new MAA_CTRL_NS::FileController(MAA_CTRL_NS::FileController::Source::Video, path, config, callback,
+                                               callback_arg);
+    }
+    catch (const std::exception& e) {
+        LogError << "Failed to create video controller: " << e.what();
+        return nullptr;
+    }
+}
+
+MaaControllerHandle MaaImageDirControllerCreate(MaaStringView dir, MaaStringView config,
+                                                MaaControllerCallback callback, MaaCallbackTransparentArg callback_arg)
+{
+    LogFunc << VAR(dir) << VAR(config) << VAR_VOIDP(callback) << VAR_VOIDP(callback_arg);
+
+    try {
+        return new MAA_CTRL_NS::FileController(MAA_CTRL_NS::FileController::Source::ImageDir, dir, config, callback,
+                                               callback_arg);
+    }
+    catch (const std::exception& e) {
+        LogError << "Failed to create image dir controller: " << e.what();
+        return nullptr;
+    }
+}
+
 MaaControllerHandle MaaCustomControllerCreate(MaaCustomControllerHandle handle, MaaControllerCallback callback,
                                               MaaCallbackTransparentArg callback_arg)
 {
@@ -497,6 +569,18 @@ MaaCtrlId MaaControllerPostTouchUp(MaaControllerHandle ctrl, int32_t contact)
     return ctrl->post_touch_up(contact);
 }
 
+MaaCtrlId MaaControllerPostGesture(MaaControllerHandle ctrl, MaaStringView events)
+{
+    LogFunc << VAR_VOIDP(ctrl) << VAR(events);
+
+    if (!ctrl) {
+        LogError << "handle is null";
+        return MaaInvalidId;
+    }
+
+    return ctrl->post_gesture(events);
+}
+
 MaaCtrlId MaaControllerPostScreencap(MaaControllerHandle ctrl)
 {
     LogFunc << VAR_VOIDP(ctrl);
@@ -533,6 +617,19 @@ MaaStatus MaaControllerWait(MaaControllerHandle ctrl, MaaCtrlId id)
     return ctrl->wait(id);
 }
 
+MaaBool MaaControllerWaitAll(MaaControllerHandle ctrl)
+{
+    // LogFunc << VAR_VOIDP(ctrl);
+
+    if (!ctrl) {
+        LogError << "handle is null";
+        return false;
+    }
+
+    ctrl->wait_all();
+    return true;
+}
+
 MaaBool MaaControllerConnected(MaaControllerHandle ctrl)
 {
     LogFunc << VAR_VOIDP(ctrl);
@@ -562,6 +659,42 @@ MaaBool MaaControllerGetImage(MaaControllerHandle ctrl, MaaImageBufferHandle buf
     return true;
 }
 
+MaaBool MaaControllerGetChangedRegions(MaaControllerHandle ctrl, MaaStringBufferHandle buffer)
+{
+    if (!ctrl || !buffer) {
+        LogError << "handle is null";
+        return false;
+    }
+
+    auto regions = ctrl->get_changed_regions();
+    if (!regions) {
+        return false;
+    }
+
+    json::array result;
+    for (const auto& r : *regions) {
+        result.emplace_back(json::array { r.x, r.y, r.width, r.height });
+    }
+    buffer->set(result.to_string());
+    return true;
+}
+
+MaaBool MaaControllerGetScreencapStats(MaaControllerHandle ctrl, MaaStringBufferHandle buffer)
+{
+    if (!ctrl || !buffer) {
+        LogError << "handle is null";
+        return false;
+    }
+
+    auto stats = ctrl->get_screencap_stats();
+    if (!stats) {
+        return false;
+    }
+
+    buffer->set(std::move(*stats));
+    return true;
+}
+
 MaaBool MaaControllerGetUUID(MaaControllerHandle ctrl, MaaStringBufferHandle buffer)
 {
     if (!ctrl || !buffer) {
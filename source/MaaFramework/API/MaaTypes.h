@@ -5,6 +5,7 @@
 #include "Utils/NoWarningCVMat.hpp"
 
 #include <filesystem>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -47,12 +48,16 @@ public:
     virtual MaaCtrlId post_touch_down(int contact, int x, int y, int pressure) = 0;
     virtual MaaCtrlId post_touch_move(int contact, int x, int y, int pressure) = 0;
     virtual MaaCtrlId post_touch_up(int contact) = 0;
+    virtual MaaCtrlId post_gesture(const std::string& events) = 0;
 
     virtual MaaStatus status(MaaCtrlId ctrl_id) const = 0;
     virtual MaaStatus wait(MaaCtrlId ctrl_id) const = 0;
+    virtual void wait_all() const = 0;
     virtual MaaBool connected() const = 0;
 
     virtual cv::Mat get_image() const = 0;
+    virtual std::optional<std::vector<cv::Rect>> get_changed_regions() const = 0;
+    virtual std::optional<std::string> get_screencap_stats() const = 0;
     virtual std::string get_uuid() const = 0;
 };
 
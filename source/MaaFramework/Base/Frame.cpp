@@ -0,0 +1,56 @@
+#include "Frame.h"
+
+#include "Utils/Logger.h"
+#include "Utils/NoWarningCV.hpp"
+
+MAA_NS_BEGIN
+
+Frame::Frame(cv::Mat image, uint64_t id, Clock::time_point capture_time,
+             std::optional<std::vector<cv::Rect>> changed_regions)
+    : data_(std::make_shared<const Data>(std::move(image), id, capture_time, std::move(changed_regions)))
+{}
+
+const cv::Mat& Frame::image() const
+{
+    static const cv::Mat kEmpty;
+    return data_ ? data_->image : kEmpty;
+}
+
+const std::optional<std::vector<cv::Rect>>& Frame::changed_regions() const
+{
+    static const std::optional<std::vector<cv::Rect>> kUnknown;
+    return data_ ? data_->changed_regions : kUnknown;
+}
+
+cv::Mat Frame::cvt_color(int code, const cv::Rect& roi) const
+{
+    DerivedKey key { Derived::CvtColor, code, roi.x, roi.y, roi.width, roi.height };
+    return get_or_compute(key, [&]() {
+        cv::Mat dst;
+        cv::cvtColor(image()(roi), dst, code);
+        return dst;
+    });
+}
+
+template <typename ComputeFunc>
+cv::Mat Frame::get_or_compute(const DerivedKey& key, ComputeFunc compute) const
+{
+    if (empty()) {
+        return {};
+    }
+
+    {
+        std::unique_lock lock { data_->derived_mutex };
+        if (auto it = data_->derived.find(key); it != data_->derived.end()) {
+            return it->second;
+        }
+    }
+
+    // 计算时不持锁，不然一个识别器在算的时候别的识别器连已经算好的都拿不到
+    cv::Mat result = compute();
+
+    std::unique_lock lock { data_->derived_mutex };
+    return data_->derived.try_emplace(key, std::move(result)).first->second;
+}
+
+MAA_NS_END
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Conf/Conf.h"
+#include "Utils/NoWarningCVMat.hpp"
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+MAA_NS_BEGIN
+
+// 一帧截图，构造后不可修改，拷贝只增加引用计数
+// 从控制器一路传给识别器，避免每一层都 clone 一次
+class Frame
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+public:
+    Frame() = default;
+    explicit Frame(cv::Mat image, uint64_t id = 0, Clock::time_point capture_time = Clock::now(),
+                   std::optional<std::vector<cv::Rect>> changed_regions = std::nullopt);
+
+    bool empty() const { return !data_ || data_->image.empty(); }
+
+    // 与其他持有者共享数据，不要写入
+    const cv::Mat& image() const;
+    uint64_t id() const { return data_ ? data_->id : 0; }
+    Clock::time_point capture_time() const { return data_ ? data_->capture_time : Clock::time_point {}; }
+    // 相对控制器上一次截的图变了的区域，截图方式不知道的话是 nullopt，当作整张都变了
+    const std::optional<std::vector<cv::Rect>>& changed_regions() const;
+
+    // 以下均由 image() 派生，第一次用到时计算并缓存在这一帧上，同一帧的多个识别器共用一份
+    // 返回的 Mat 同样不要写入
+    // 只转 roi 这一块（需已在图内），按 (code, roi) 缓存：同一块区域查不同颜色的节点共用一次转换
+    cv::Mat cvt_color(int code, const cv::Rect& roi) const; // 灰度、HSV、Lab 等，code 同 cv::cvtColor
+
+private:
+    enum class Derived
+    {
+        CvtColor,
+    };
+    // 类型、参数、roi 的 x, y, width, height
+    using DerivedKey = std::tuple<Derived, int, int, int, int, int>;
+
+    struct Data
+    {
+        Data(cv::Mat i, uint64_t n, Clock::time_point t, std::optional<std::vector<cv::Rect>> c)
+            : image(std::move(i)), id(n), capture_time(t), changed_regions(std::move(c))
+        {}
+
+        const cv::Mat image;
+        const uint64_t id = 0;
+        const Clock::time_point capture_time;
+        const std::optional<std::vector<cv::Rect>> changed_regions;
+
+        mutable std::mutex derived_mutex;
+        mutable std::map<DerivedKey, cv::Mat> derived;
+    };
+
+    template <typename ComputeFunc>
+    cv::Mat get_or_compute(const DerivedKey& key, ComputeFunc compute) const;
+
+    std::shared_ptr<const Data> data_ = nullptr;
+};
+
+MAA_NS_END
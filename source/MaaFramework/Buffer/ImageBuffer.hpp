@@ -47,6 +47,13 @@ public:
         image_ = image.clone();
     }
 
+    // 不拷贝，直接引用传入的图像，对外是只读的（见 MaaAPI.h 的 MaaGetImageRawData）
+    void share(cv::Mat image)
+    {
+        dirty_ = true;
+        image_ = std::move(image);
+    }
+
 private:
     void encode()
     {
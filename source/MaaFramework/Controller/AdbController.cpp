@@ -1,9 +1,14 @@
 #include "AdbController.h"
 
 #include "MaaFramework/MaaMsg.h"
+#include "Option/GlobalOptionMgr.h"
+#include "Utils/Format.hpp"
 #include "Utils/Logger.h"
 #include "Utils/StringMisc.hpp"
 
+#include <fstream>
+#include <future>
+
 #include <meojson/json.hpp>
 
 MAA_CTRL_NS_BEGIN
@@ -66,7 +71,18 @@ bool AdbController::_connect()
         return false;
     }
 
-    if (!unit_mgr_->device_info_obj()->request_uuid()) {
+    // 几个查询互不依赖，一起发
+    auto device_info = unit_mgr_->device_info_obj();
+    auto uuid_future = std::async(std::launch::async, [device_info]() { return device_info->request_uuid(); });
+    auto resolution_future =
+        std::async(std::launch::async, [device_info]() { return device_info->request_resolution(); });
+    auto orientation_future =
+        std::async(std::launch::async, [device_info]() { return device_info->request_orientation(); });
+    bool uuid_got = uuid_future.get().has_value();
+    bool resolution_got = resolution_future.get().has_value();
+    auto orientation_opt = orientation_future.get();
+
+    if (!uuid_got) {
         notifier.notify(MaaMsg_Controller_UUIDGetFailed, details);
         notifier.notify(MaaMsg_Controller_ConnectFailed, details | json::object { { "why", "UUIDGetFailed" } });
         LogError << "failed to request_uuid";
@@ -77,7 +93,7 @@ bool AdbController::_connect()
 
     notifier.notify(MaaMsg_Controller_UUIDGot, details | json::object { { "uuid", uuid } });
 
-    if (!unit_mgr_->device_info_obj()->request_resolution()) {
+    if (!resolution_got) {
         notifier.notify(MaaMsg_Controller_ResolutionGetFailed, details);
         notifier.notify(MaaMsg_Controller_ConnectFailed, details | json::object { { "why", "ResolutionGetFailed" } });
         LogError << "failed to request_resolution";
@@ -85,20 +101,32 @@ bool AdbController::_connect()
     }
     auto [w, h] = unit_mgr_->device_info_obj()->get_resolution();
     resolution_ = { w, h };
-    int orientation = unit_mgr_->device_info_obj()->request_orientation().value_or(0);
+    int orientation = orientation_opt.value_or(0);
     details |= { { "resolution", { { "width", w }, { "height", h } } }, { "orientation", orientation } };
 
     notifier.notify(MaaMsg_Controller_ResolutionGot, details);
 
-    if (!unit_mgr_->screencap_obj()->init(w, h)) {
+    // 截图（要逐个测速）和触控（要推送、启动二进制）互不依赖，并行初始化，消息仍按原来的顺序发
+    std::string profile_key = MAA_FMT::format("{}_{}x{}", uuid, w, h);
+    unit_mgr_->screencap_obj()->set_preferred_methods(load_screencap_profile(profile_key));
+
+    auto touch_input = unit_mgr_->touch_input_obj();
+    auto touch_future = std::async(std::launch::async, [touch_input, w = w, h = h, orientation]() {
+        return touch_input->init(w, h, orientation);
+    });
+    bool screencap_inited = unit_mgr_->screencap_obj()->init(w, h);
+    bool touch_inited = touch_future.get();
+
+    if (!screencap_inited) {
         notifier.notify(MaaMsg_Controller_ScreencapInitFailed, details);
         notifier.notify(MaaMsg_Controller_ConnectFailed, details | json::object { { "why", "ScreencapInitFailed" } });
         LogError << "failed to init screencap";
         return false;
     }
     notifier.notify(MaaMsg_Controller_ScreencapInited, details);
+    save_screencap_profile(profile_key, unit_mgr_->screencap_obj()->get_preferred_methods());
 
-    if (!unit_mgr_->touch_input_obj()->init(w, h, orientation)) {
+    if (!touch_inited) {
         notifier.notify(MaaMsg_Controller_TouchInputInitFailed, details);
         notifier.notify(MaaMsg_Controller_ConnectFailed, details | json::object { { "why", "TouchInputInitFailed" } });
         LogError << "failed to init touch_input";
@@ -196,6 +224,22 @@ bool AdbController::_touch_up(TouchParam param)
     return ret;
 }
 
+bool AdbController::_gesture(GestureParam param)
+{
+    if (!unit_mgr_ || !unit_mgr_->touch_input_obj()) {
+        LogError << "unit is nullptr" << VAR(unit_mgr_) << VAR(unit_mgr_->touch_input_obj());
+        return false;
+    }
+
+    bool ret = unit_mgr_->touch_input_obj()->gesture(to_touch_events(param));
+
+    if (!ret) {
+        LogError << "failed to gesture";
+    }
+
+    return ret;
+}
+
 bool AdbController::_press_key(PressKeyParam param)
 {
     if (!unit_mgr_ || !unit_mgr_->key_input_obj()) {
@@ -226,6 +270,54 @@ cv::Mat AdbController::_screencap()
     return std::move(ret.value());
 }
 
+void AdbController::_set_screencap_target_size(int width, int height)
+{
+    if (!unit_mgr_ || !unit_mgr_->screencap_obj()) {
+        LogError << "unit is nullptr" << VAR(unit_mgr_) << VAR(unit_mgr_->screencap_obj());
+        return;
+    }
+
+    unit_mgr_->screencap_obj()->set_target_size(width, height);
+}
+
+std::optional<std::vector<cv::Rect>> AdbController::_screencap_changed_regions() const
+{
+    if (!unit_mgr_ || !unit_mgr_->screencap_obj()) {
+        return std::nullopt;
+    }
+
+    return unit_mgr_->screencap_obj()->changed_regions();
+}
+
+std::optional<json::value> AdbController::_screencap_stats() const
+{
+    if (!unit_mgr_ || !unit_mgr_->screencap_obj()) {
+        return std::nullopt;
+    }
+
+    auto method = unit_mgr_->screencap_obj()->get_current_method();
+    if (method.empty()) {
+        return std::nullopt;
+    }
+
+    json::array methods;
+    for (const auto& stats : unit_mgr_->screencap_obj()->get_method_stats()) {
+        methods.emplace_back(json::object {
+            { "method", stats.method },
+            { "success", stats.success },
+            { "failure", stats.failure },
+            { "consecutive_failure", stats.consecutive_failure },
+            { "median", stats.median },
+            { "p90", stats.p90 },
+            { "baseline", stats.baseline },
+        });
+    }
+    return json::object {
+        { "method", method },
+        { "stats", std::move(methods) },
+    };
+}
+
 bool AdbController::_start_app(AppParam param)
 {
     if (!unit_mgr_ || !unit_mgr_->activity_obj()) {
@@ -280,4 +372,64 @@ bool AdbController::reinit_resolution()
     return true;
 }
 
+std::filesystem::path AdbController::profile_path()
+{
+    const auto& logging_path = GlobalOptionMgr::get_instance().logging_path();
+    if (logging_path.empty()) {
+        return {};
+    }
+    return logging_path / "device_profile.json";
+}
+
+std::vector<std::string> AdbController::load_screencap_profile(const std::string& key) const
+{
+    auto path = profile_path();
+    if (path.empty() || !std::filesystem::exists(path)) {
+        return {};
+    }
+
+    std::unique_lock<std::mutex> lock(profile_mutex_);
+    auto json_opt = json::open(path);
+    if (!json_opt) {
+        LogWarn << "failed to open profile" << VAR(path);
+        return {};
+    }
+
+    auto methods_opt = json_opt->find<json::array>(key);
+    if (!methods_opt) {
+        return {};
+    }
+
+    std::vector<std::string> methods;
+    for (const auto& method : *methods_opt) {
+        if (method.is_string()) {
+            methods.emplace_back(method.as_string());
+        }
+    }
+    LogInfo << VAR(key) << VAR(methods);
+    return methods;
+}
+
+void AdbController::save_screencap_profile(const std::string& key, const std::vector<std::string>& methods) const
+{
+    auto path = profile_path();
+    if (path.empty() || methods.empty()) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(profile_mutex_);
+    json::value root = json::open(path).value_or(json::object());
+    if (!root.is_object()) {
+        root = json::object();
+    }
+    root[key] = json::array(methods);
+
+    std::ofstream ofs(path, std::ios::out);
+    if (!ofs.is_open()) {
+        LogWarn << "failed to write profile" << VAR(path);
+        return;
+    }
+    ofs << root;
+}
+
 MAA_CTRL_NS_END
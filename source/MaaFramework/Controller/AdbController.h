@@ -3,7 +3,9 @@
 
 #include "ControlUnit/ControlUnitAPI.h"
 
+#include <filesystem>
 #include <memory>
+#include <mutex>
 
 MAA_CTRL_NS_BEGIN
 
@@ -24,14 +26,27 @@ protected:
     virtual bool _touch_down(TouchParam param) override;
     virtual bool _touch_move(TouchParam param) override;
     virtual bool _touch_up(TouchParam param) override;
+    virtual bool _gesture(GestureParam param) override;
     virtual bool _press_key(PressKeyParam param) override;
     virtual cv::Mat _screencap() override;
+    virtual void _set_screencap_target_size(int width, int height) override;
+    virtual std::optional<std::vector<cv::Rect>> _screencap_changed_regions() const override;
+    virtual std::optional<json::value> _screencap_stats() const override;
+    // 截图和输入是不同的 unit，各自有自己的连接
+    virtual bool _support_parallel_lanes() const override { return true; }
     virtual bool _start_app(AppParam param) override;
     virtual bool _stop_app(AppParam param) override;
 
 private:
     bool reinit_resolution();
 
+    // 按 uuid + 分辨率缓存设备画像（目前是截图方式排名），重连时跳过完整测速
+    static std::filesystem::path profile_path();
+    std::vector<std::string> load_screencap_profile(const std::string& key) const;
+    void save_screencap_profile(const std::string& key, const std::vector<std::string>& methods) const;
+
+    inline static std::mutex profile_mutex_;
+
     std::string adb_path_;
     std::string address_;
     std::pair<int, int> resolution_ = { 0, 0 };
@@ -2,8 +2,12 @@
 
 #include "MaaFramework/MaaMsg.h"
 #include "Resource/ResourceMgr.h"
+#include "SessionRecorder.h"
+#include "Utils/MatPool.hpp"
 #include "Utils/NoWarningCV.hpp"
+#include "Utils/Platform.h"
 
+#include <algorithm>
 #include <tuple>
 
 MAA_CTRL_NS_BEGIN
@@ -15,17 +19,18 @@ ControllerMgr::ControllerMgr(MaaControllerCallback callback, MaaCallbackTranspar
 {
     LogFunc << VAR_VOIDP(callback) << VAR_VOIDP(callback_arg);
 
-    action_runner_ = std::make_unique<AsyncRunner<Action>>(
-        std::bind(&ControllerMgr::run_action, this, std::placeholders::_1, std::placeholders::_2));
+    for (Lane* lane : { &capture_lane_, &input_lane_, &app_lane_ }) {
+        lane->runner = std::make_unique<AsyncRunner<Action>>(
+            std::bind(&ControllerMgr::run_action, this, std::placeholders::_1, std::placeholders::_2));
+    }
 }
 
 ControllerMgr::~ControllerMgr()
 {
     LogFunc;
 
-    if (action_runner_) {
-        action_runner_->release();
-    }
+    stop_capture_ahead();
+    release_lanes();
 }
 
 bool ControllerMgr::set_option(MaaCtrlOption key, MaaOptionValue value, MaaOptionValueSize val_size)
@@ -43,6 +48,15 @@ bool ControllerMgr::set_option(MaaCtrlOption key, MaaOptionValue value, MaaOptio
     case MaaCtrlOption_DefaultAppPackage:
         return set_default_app_package(value, val_size);
 
+    case MaaCtrlOption_CaptureAhead:
+        return set_capture_ahead(value, val_size);
+
+    case MaaCtrlOption_Recording:
+        return set_recording(value, val_size);
+
+    case MaaCtrlOption_ParallelLanes:
+        return set_parallel_lanes(value, val_size);
+
     default:
         LogError << "Unknown key" << VAR(key) << VAR(value);
         return false;
@@ -51,20 +65,14 @@ bool ControllerMgr::set_option(MaaCtrlOption key, MaaOptionValue value, MaaOptio
 
 MaaCtrlId ControllerMgr::post_connection()
 {
-    auto id = action_runner_->post({ .type = Action::Type::connect });
-    std::unique_lock lock { post_ids_mutex_ };
-    post_ids_.emplace(id);
-    return id;
+    return post({ .type = Action::Type::connect }, true);
 }
 
 MaaCtrlId ControllerMgr::post_click(int x, int y)
 {
     auto [xx, yy] = preproc_touch_point(x, y);
     ClickParam param { .x = xx, .y = yy };
-    auto id = action_runner_->post({ .type = Action::Type::click, .param = std::move(param) });
-    std::unique_lock lock { post_ids_mutex_ };
-    post_ids_.emplace(id);
-    return id;
+    return post({ .type = Action::Type::click, .param = std::move(param) }, true);
 }
 
 MaaCtrlId ControllerMgr::post_swipe(int x1, int y1, int x2, int y2, int duration)
@@ -72,75 +80,85 @@ MaaCtrlId ControllerMgr::post_swipe(int x1, int y1, int x2, int y2, int duration
     auto [xx1, yy1] = preproc_touch_point(x1, y1);
     auto [xx2, yy2] = preproc_touch_point(x2, y2);
     SwipeParam param { .x1 = xx1, .y1 = yy1, .x2 = xx2, .y2 = yy2, .duration = duration };
-    auto id = action_runner_->post({ .type = Action::Type::swipe, .param = std::move(param) });
-    std::unique_lock lock { post_ids_mutex_ };
-    post_ids_.emplace(id);
-    return id;
+    return post({ .type = Action::Type::swipe, .param = std::move(param) }, true);
 }
 
 MaaCtrlId ControllerMgr::post_press_key(int keycode)
 {
     PressKeyParam param { .keycode = keycode };
-    auto id = action_runner_->post({ .type = Action::Type::press_key, .param = std::move(param) });
-    std::unique_lock lock { post_ids_mutex_ };
-    post_ids_.emplace(id);
-    return id;
+    return post({ .type = Action::Type::press_key, .param = std::move(param) }, true);
 }
 
 MaaCtrlId ControllerMgr::post_screencap()
 {
-    auto id = action_runner_->post({ .type = Action::Type::screencap });
-    std::unique_lock lock { post_ids_mutex_ };
-    post_ids_.emplace(id);
-    return id;
+    return post({ .type = Action::Type::screencap }, true);
 }
 
 MaaCtrlId ControllerMgr::post_touch_down(int contact, int x, int y, int pressure)
 {
     auto [xx, yy] = preproc_touch_point(x, y);
     TouchParam param { .contact = contact, .x = xx, .y = yy, .pressure = pressure };
-    auto id = action_runner_->post({ .type = Action::Type::touch_down, .param = std::move(param) });
-    std::unique_lock lock { post_ids_mutex_ };
-    post_ids_.emplace(id);
-    return id;
+    return post({ .type = Action::Type::touch_down, .param = std::move(param) }, true);
 }
 
 MaaCtrlId ControllerMgr::post_touch_move(int contact, int x, int y, int pressure)
 {
     auto [xx, yy] = preproc_touch_point(x, y);
     TouchParam param { .contact = contact, .x = xx, .y = yy, .pressure = pressure };
-    auto id = action_runner_->post({ .type = Action::Type::touch_move, .param = std::move(param) });
-    std::unique_lock lock { post_ids_mutex_ };
-    post_ids_.emplace(id);
-    return id;
+    return post({ .type = Action::Type::touch_move, .param = std::move(param) }, true);
 }
 
 MaaCtrlId ControllerMgr::post_touch_up(int contact)
 {
     TouchParam param { .contact = contact };
-    auto id = action_runner_->post({ .type = Action::Type::touch_up, .param = std::move(param) });
-    std::unique_lock lock { post_ids_mutex_ };
-    post_ids_.emplace(id);
-    return id;
+    return post({ .type = Action::Type::touch_up, .param = std::move(param) }, true);
+}
+
+MaaCtrlId ControllerMgr::post_gesture(const std::string& events)
+{
+    auto param_opt = parse_gesture(events);
+    if (!param_opt) {
+        LogError << "Invalid gesture" << VAR(events);
+        return MaaInvalidId;
+    }
+    return post({ .type = Action::Type::gesture, .param = std::move(*param_opt) }, true);
 }
 
 MaaStatus ControllerMgr::status(MaaCtrlId ctrl_id) const
 {
-    if (!action_runner_) {
-        LogError << "action_runner_ is nullptr";
+    const Lane* lane = find_lane(ctrl_id);
+    if (!lane) {
         return MaaStatus_Invalid;
     }
-    return action_runner_->status(ctrl_id);
+    return lane->runner->status(ctrl_id);
 }
 
 MaaStatus ControllerMgr::wait(MaaCtrlId ctrl_id) const
 {
-    if (!action_runner_) {
-        LogError << "action_runner_ is nullptr";
+    const Lane* lane = find_lane(ctrl_id);
+    if (!lane) {
+        LogError << "Unknown ctrl id" << VAR(ctrl_id);
         return MaaStatus_Invalid;
     }
-    action_runner_->wait(ctrl_id);
-    return action_runner_->status(ctrl_id);
+    lane->runner->wait(ctrl_id);
+    return lane->runner->status(ctrl_id);
+}
+
+void ControllerMgr::wait_all() const
+{
+    std::vector<std::pair<const Lane*, MaaCtrlId>> last_ids;
+    {
+        std::unique_lock lock { post_ids_mutex_ };
+        for (const Lane* lane : { &capture_lane_, &input_lane_, &app_lane_ }) {
+            last_ids.emplace_back(lane, lane->last_id);
+        }
+    }
+
+    for (const auto& [lane, id] : last_ids) {
+        if (id != 0) {
+            lane->runner->wait(id);
+        }
+    }
 }
 
 MaaBool ControllerMgr::connected() const
@@ -150,12 +168,29 @@ MaaBool ControllerMgr::connected() const
 
 cv::Mat ControllerMgr::get_image() const
 {
-    return image_;
+    std::unique_lock lock { image_mutex_ };
+    return image_.image();
+}
+
+std::optional<std::vector<cv::Rect>> ControllerMgr::get_changed_regions() const
+{
+    std::unique_lock lock { image_mutex_ };
+    return image_.changed_regions();
+}
+
+std::optional<std::string> ControllerMgr::get_screencap_stats() const
+{
+    auto stats = _screencap_stats();
+    if (!stats) {
+        return std::nullopt;
+    }
+    return stats->to_string();
 }
 
 void ControllerMgr::on_stop()
 {
-    action_runner_->release();
+    stop_capture_ahead();
+    release_lanes();
 }
 
 bool ControllerMgr::click(const cv::Rect& r)
@@ -166,7 +201,8 @@ bool ControllerMgr::click(const cv::Rect& r)
 bool ControllerMgr::click(const cv::Point& p)
 {
     auto id = post_click(p.x, p.y);
-    return status(id) == MaaStatus_Success;
+    // 分通道时输入和截图不在一条队列上，要等做完，调用方接着截的图才是点完之后的
+    return wait(id) == MaaStatus_Success;
 }
 
 bool ControllerMgr::swipe(const cv::Rect& r1, const cv::Rect& r2, int duration)
@@ -177,20 +213,25 @@ bool ControllerMgr::swipe(const cv::Rect& r1, const cv::Rect& r2, int duration)
 bool ControllerMgr::swipe(const cv::Point& p1, const cv::Point& p2, int duration)
 {
     auto id = post_swipe(p1.x, p1.y, p2.x, p2.y, duration);
-    return status(id) == MaaStatus_Success;
+    return wait(id) == MaaStatus_Success;
 }
 
 bool ControllerMgr::press_key(int keycode)
 {
     auto id = post_press_key(keycode);
-    return status(id) == MaaStatus_Success;
+    return wait(id) == MaaStatus_Success;
 }
 
-cv::Mat ControllerMgr::screencap()
+Frame ControllerMgr::screencap()
 {
-    std::unique_lock<std::mutex> lock(image_mutex_);
-    action_runner_->post({ .type = Action::Type::screencap }, true);
-    return image_.clone();
+    if (capture_ahead_ && connected_) {
+        return screencap_ahead();
+    }
+
+    post({ .type = Action::Type::screencap }, false, true);
+    // 别的线程同时在截图的话，拿到的可能是更新的一帧
+    std::unique_lock lock { image_mutex_ };
+    return image_;
 }
 
 bool ControllerMgr::start_app()
@@ -213,13 +254,13 @@ bool ControllerMgr::stop_app()
 
 bool ControllerMgr::start_app(const std::string& package)
 {
-    auto id = action_runner_->post({ .type = Action::Type::start_app, .param = AppParam { .package = package } }, true);
+    auto id = post({ .type = Action::Type::start_app, .param = AppParam { .package = package } }, false, true);
     return status(id) == MaaStatus_Success;
 }
 
 bool ControllerMgr::stop_app(const std::string& package)
 {
-    auto id = action_runner_->post({ .type = Action::Type::stop_app, .param = AppParam { .package = package } }, true);
+    auto id = post({ .type = Action::Type::stop_app, .param = AppParam { .package = package } }, false, true);
     return status(id) == MaaStatus_Success;
 }
 
@@ -246,10 +287,92 @@ cv::Point ControllerMgr::rand_point(const cv::Rect& r)
     return { x, y };
 }
 
+ControllerMgr::Lane& ControllerMgr::lane_of(Action::Type type)
+{
+    if (!parallel_lanes_) {
+        return app_lane_;
+    }
+
+    switch (type) {
+    case Action::Type::screencap:
+        return capture_lane_;
+
+    case Action::Type::click:
+    case Action::Type::swipe:
+    case Action::Type::touch_down:
+    case Action::Type::touch_move:
+    case Action::Type::touch_up:
+    case Action::Type::gesture:
+    case Action::Type::press_key:
+        return input_lane_;
+
+    default: // connect, start_app, stop_app
+        return app_lane_;
+    }
+}
+
+const ControllerMgr::Lane* ControllerMgr::find_lane(MaaCtrlId id) const
+{
+    // id 是全局唯一的，只有提交到的那条队列认识它
+    for (const Lane* lane : { &capture_lane_, &input_lane_, &app_lane_ }) {
+        if (lane->runner->status(id) != MaaStatus_Invalid) {
+            return lane;
+        }
+    }
+    return nullptr;
+}
+
+MaaCtrlId ControllerMgr::post(Action action, bool notify, bool block)
+{
+    Lane& lane = lane_of(action.type);
+    bool is_connect = action.type == Action::Type::connect;
+
+    auto id = lane.runner->post(std::move(action));
+    {
+        std::unique_lock lock { post_ids_mutex_ };
+        lane.last_id = id;
+        if (notify) {
+            post_ids_.emplace(id);
+        }
+    }
+    if (is_connect) {
+        connect_id_ = id;
+    }
+
+    if (block) {
+        lane.runner->wait(id);
+    }
+    return id;
+}
+
+void ControllerMgr::release_lanes()
+{
+    for (Lane* lane : { &capture_lane_, &input_lane_, &app_lane_ }) {
+        if (lane->runner) {
+            lane->runner->release();
+        }
+    }
+}
+
+ControllerMgr::ControllerLock ControllerMgr::lock_controller(Action::Type type)
+{
+    bool shared = parallel_lanes_ && type != Action::Type::connect && type != Action::Type::start_app &&
+                  type != Action::Type::stop_app;
+    if (shared) {
+        return std::shared_lock { controller_mutex_ };
+    }
+    return std::unique_lock { controller_mutex_ };
+}
+
 bool ControllerMgr::run_action(typename AsyncRunner<Action>::Id id, Action action)
 {
     // LogFunc << VAR(id) << VAR(action);
 
+    if (auto connect_id = connect_id_.load(); connect_id != 0 && connect_id < id) {
+        // 连接之后才提交的，不管哪个通道都要等连接做完
+        app_lane_.runner->wait(connect_id);
+    }
+
     bool ret = false;
 
     bool notify = false;
@@ -266,6 +389,8 @@ bool ControllerMgr::run_action(typename AsyncRunner<Action>::Id id, Action actio
         notifier.notify(MaaMsg_Controller_Action_Started, details);
     }
 
+    auto ctrl_lock = lock_controller(action.type);
+
     switch (action.type) {
     case Action::Type::connect:
         ret = _connect();
@@ -288,14 +413,25 @@ bool ControllerMgr::run_action(typename AsyncRunner<Action>::Id id, Action actio
     case Action::Type::touch_up:
         ret = _touch_up(std::get<TouchParam>(action.param));
         break;
+    case Action::Type::gesture:
+        ret = _gesture(std::get<GestureParam>(action.param));
+        break;
 
     case Action::Type::press_key:
         ret = _press_key(std::get<PressKeyParam>(action.param));
         break;
 
-    case Action::Type::screencap:
-        ret = postproc_screenshot(_screencap());
-        break;
+    case Action::Type::screencap: {
+        std::unique_lock lock { screencap_mutex_ };
+        auto capture_time = Frame::Clock::now();
+        Frame frame;
+        ret = postproc_screenshot(record_screencap(capture_time), capture_time, frame);
+        if (ret) {
+            // 还在 screencap_mutex_ 里，保证 image_ 按截图顺序更新
+            std::unique_lock image_lock { image_mutex_ };
+            image_ = std::move(frame);
+        }
+    } break;
 
     case Action::Type::start_app:
         ret = _start_app(std::get<AppParam>(action.param));
@@ -310,6 +446,21 @@ bool ControllerMgr::run_action(typename AsyncRunner<Action>::Id id, Action actio
         LogError << "Unknown action type" << VAR(static_cast<int>(action.type));
         ret = false;
     }
+    std::visit([](auto& lock) { lock.unlock(); }, ctrl_lock);
+
+    if (action.type != Action::Type::screencap) {
+        if (auto rec = recorder()) {
+            rec->record_action(action, ret);
+            if (action.type == Action::Type::connect && ret) {
+                auto [res_w, res_h] = _get_resolution();
+                rec->record_resolution(res_w, res_h);
+            }
+        }
+
+        // 动作之前开始截的帧已经过期了
+        std::unique_lock lock { ahead_mutex_ };
+        last_action_time_ = std::chrono::steady_clock::now();
+    }
 
     if (notify) {
         notifier.notify(ret ? MaaMsg_Controller_Action_Completed : MaaMsg_Controller_Action_Failed, details);
@@ -321,15 +472,16 @@ bool ControllerMgr::run_action(typename AsyncRunner<Action>::Id id, Action actio
 std::pair<int, int> ControllerMgr::preproc_touch_point(int x, int y)
 {
     auto [res_w, res_h] = _get_resolution();
+    auto [target_w, target_h] = image_target_size();
 
-    if (image_target_width_ == 0 || image_target_height_ == 0) {
+    if (target_w == 0 || target_h == 0) {
         // 正常来说连接完后都会截个图测试，那时候就会走到 check_and_calc_target_image_size，这里不应该是 0
-        LogError << "Invalid image target size" << VAR(image_target_width_) << VAR(image_target_height_);
+        LogError << "Invalid image target size" << VAR(target_w) << VAR(target_h);
         return {};
     }
 
-    double scale_width = static_cast<double>(res_w) / image_target_width_;
-    double scale_height = static_cast<double>(res_h) / image_target_height_;
+    double scale_width = static_cast<double>(res_w) / target_w;
+    double scale_height = static_cast<double>(res_h) / target_h;
 
     int proced_x = static_cast<int>(std::round(x * scale_width));
     int proced_y = static_cast<int>(std::round(y * scale_height));
@@ -337,15 +489,106 @@ std::pair<int, int> ControllerMgr::preproc_touch_point(int x, int y)
     return { proced_x, proced_y };
 }
 
-bool ControllerMgr::postproc_screenshot(const cv::Mat& raw)
+std::optional<GestureParam> ControllerMgr::parse_gesture(const std::string& events)
+{
+    static const std::map<std::string, GestureParam::Event::Type> kTypes = {
+        { "down", GestureParam::Event::Type::down },
+        { "move", GestureParam::Event::Type::move },
+        { "up", GestureParam::Event::Type::up },
+    };
+
+    auto json_opt = json::parse(events);
+    if (!json_opt || !json_opt->is_array()) {
+        return std::nullopt;
+    }
+
+    GestureParam param;
+    for (const auto& event_json : json_opt->as_array()) {
+        if (!event_json.is_object()) {
+            return std::nullopt;
+        }
+        auto type_iter = kTypes.find(event_json.get("type", std::string()));
+        if (type_iter == kTypes.end()) {
+            LogError << "Invalid event type" << VAR(event_json);
+            return std::nullopt;
+        }
+
+        GestureParam::Event event {
+            .type = type_iter->second,
+            .contact = event_json.get("contact", 0),
+            .pressure = event_json.get("pressure", 0),
+            .time = event_json.get("time", 0),
+        };
+        if (event.type != GestureParam::Event::Type::up) {
+            std::tie(event.x, event.y) = preproc_touch_point(event_json.get("x", 0), event_json.get("y", 0));
+        }
+        param.events.emplace_back(event);
+    }
+    return param;
+}
+
+bool ControllerMgr::_gesture(GestureParam param)
+{
+    using TouchEvent = MAA_CTRL_UNIT_NS::TouchEvent;
+
+    return MAA_CTRL_UNIT_NS::play_touch_events(to_touch_events(param), [&](const TouchEvent& event) {
+        TouchParam touch { .contact = event.contact, .x = event.x, .y = event.y, .pressure = event.pressure };
+        switch (event.type) {
+        case TouchEvent::Type::Down:
+            return _touch_down(touch);
+        case TouchEvent::Type::Move:
+            return _touch_move(touch);
+        case TouchEvent::Type::Up:
+            return _touch_up(touch);
+        }
+        return false;
+    });
+}
+
+std::vector<MAA_CTRL_UNIT_NS::TouchEvent> ControllerMgr::to_touch_events(const GestureParam& param)
+{
+    using TouchEvent = MAA_CTRL_UNIT_NS::TouchEvent;
+
+    std::vector<TouchEvent> events;
+    events.reserve(param.events.size());
+    for (const auto& event : param.events) {
+        TouchEvent::Type type = TouchEvent::Type::Move;
+        switch (event.type) {
+        case GestureParam::Event::Type::down:
+            type = TouchEvent::Type::Down;
+            break;
+        case GestureParam::Event::Type::move:
+            type = TouchEvent::Type::Move;
+            break;
+        case GestureParam::Event::Type::up:
+            type = TouchEvent::Type::Up;
+            break;
+        }
+        events.emplace_back(TouchEvent { .type = type,
+                                         .contact = event.contact,
+                                         .x = event.x,
+                                         .y = event.y,
+                                         .pressure = event.pressure,
+                                         .time = event.time });
+    }
+    return events;
+}
+
+bool ControllerMgr::postproc_screenshot(const cv::Mat& raw, Frame::Clock::time_point capture_time,
+                                        /*out*/ Frame& output)
 {
     if (raw.empty()) {
         LogError << "Empty screenshot";
         return false;
     }
 
+    auto [target_w, target_h] = image_target_size();
+    bool scaled_by_unit = raw.cols == target_w && raw.rows == target_h;
+
     auto [res_w, res_h] = _get_resolution();
-    if (raw.cols != res_w || raw.rows != res_h) {
+    // 截图端可能已经缩小过（比如 jpeg 缩小解码），只要不比分辨率大就算正常
+    bool reduced = raw.cols <= res_w && raw.rows <= res_h;
+    if (!scaled_by_unit && !reduced) {
         LogWarn << "Invalid resolution" << VAR(raw.cols) << VAR(raw.rows) << VAR(res_w) << VAR(res_h);
     }
 
@@ -353,13 +596,45 @@ bool ControllerMgr::postproc_screenshot(const cv::Mat& raw)
         LogError << "Invalid target image size";
         return false;
     }
+    std::tie(target_w, target_h) = image_target_size();
+
+    // 变了的区域是 raw 上的坐标，按缩放比例往外扩到目标图上
+    auto changed = _screencap_changed_regions();
+    if (changed && !scaled_by_unit) {
+        double scale_x = static_cast<double>(target_w) / raw.cols;
+        double scale_y = static_cast<double>(target_h) / raw.rows;
+        cv::Rect bound(0, 0, target_w, target_h);
+        for (auto& r : *changed) {
+            int x1 = static_cast<int>(std::floor(r.x * scale_x));
+            int y1 = static_cast<int>(std::floor(r.y * scale_y));
+            int x2 = static_cast<int>(std::ceil(r.br().x * scale_x));
+            int y2 = static_cast<int>(std::ceil(r.br().y * scale_y));
+            r = cv::Rect(x1, y1, x2 - x1, y2 - y1) & bound;
+        }
+    }
 
-    cv::resize(raw, image_, { image_target_width_, image_target_height_ });
-    return !image_.empty();
+    if (scaled_by_unit) {
+        // 截图端已经缩放好了，raw 本身就是新借出来的缓冲，直接用
+        output = Frame(raw, ++frame_id_, capture_time, std::move(changed));
+        return !output.empty();
+    }
+
+    // 之前交出去的 Frame 可能还被识别器持有着，池子只会借出没人引用的缓冲
+    cv::Mat image = MatPool::get_instance().acquire(target_h, target_w, raw.type());
+    cv::resize(raw, image, { target_w, target_h });
+    output = Frame(std::move(image), ++frame_id_, capture_time, std::move(changed));
+    return !output.empty();
+}
+
+std::pair<int, int> ControllerMgr::image_target_size() const
+{
+    std::unique_lock lock { target_size_mutex_ };
+    return { image_target_width_, image_target_height_ };
 }
 
 bool ControllerMgr::check_and_calc_target_image_size(const cv::Mat& raw)
 {
+    std::unique_lock lock { target_size_mutex_ };
     if (image_target_width_ != 0 && image_target_height_ != 0) {
         return true;
     }
@@ -398,14 +673,25 @@ bool ControllerMgr::check_and_calc_target_image_size(const cv::Mat& raw)
         }
     }
 
-    LogInfo << VAR(image_target_width_) << VAR(image_target_height_);
+    int width = image_target_width_;
+    int height = image_target_height_;
+    lock.unlock();
+
+    LogInfo << VAR(width) << VAR(height);
+    _set_screencap_target_size(width, height);
     return true;
 }
 
 void ControllerMgr::clear_target_image_size()
 {
-    image_target_width_ = 0;
-    image_target_height_ = 0;
+    // 和截图互斥，不然截图端可能还拿着旧的目标大小在缩放
+    std::unique_lock lock { screencap_mutex_ };
+    {
+        std::unique_lock target_lock { target_size_mutex_ };
+        image_target_width_ = 0;
+        image_target_height_ = 0;
+    }
+    _set_screencap_target_size(0, 0);
 }
 
 bool ControllerMgr::set_image_target_long_side(MaaOptionValue value, MaaOptionValueSize val_size)
@@ -414,12 +700,16 @@ bool ControllerMgr::set_image_target_long_side(MaaOptionValue value, MaaOptionVa
         LogError << "invalid value size: " << val_size;
         return false;
     }
-    image_target_long_side_ = *reinterpret_cast<int*>(value);
-    image_target_short_side_ = 0;
+    int side = *reinterpret_cast<int*>(value);
+    {
+        std::unique_lock lock { target_size_mutex_ };
+        image_target_long_side_ = side;
+        image_target_short_side_ = 0;
+    }
 
     clear_target_image_size();
 
-    LogInfo << "image_target_width_ = " << image_target_long_side_;
+    LogInfo << "image_target_width_ = " << side;
     return true;
 }
 
@@ -429,12 +719,16 @@ bool ControllerMgr::set_image_target_short_side(MaaOptionValue value, MaaOptionV
         LogError << "invalid value size: " << val_size;
         return false;
     }
-    image_target_long_side_ = 0;
-    image_target_short_side_ = *reinterpret_cast<int*>(value);
+    int side = *reinterpret_cast<int*>(value);
+    {
+        std::unique_lock lock { target_size_mutex_ };
+        image_target_long_side_ = 0;
+        image_target_short_side_ = side;
+    }
 
     clear_target_image_size();
 
-    LogInfo << "image_target_height_ = " << image_target_short_side_;
+    LogInfo << "image_target_height_ = " << side;
     return true;
 }
 
@@ -452,6 +746,184 @@ bool ControllerMgr::set_default_app_package(MaaOptionValue value, MaaOptionValue
     return true;
 }
 
+bool ControllerMgr::set_capture_ahead(MaaOptionValue value, MaaOptionValueSize val_size)
+{
+    if (val_size != sizeof(MaaBool)) {
+        LogError << "invalid value size: " << val_size;
+        return false;
+    }
+    capture_ahead_ = *reinterpret_cast<MaaBool*>(value);
+    if (!capture_ahead_) {
+        stop_capture_ahead();
+    }
+
+    LogInfo << "capture_ahead_ = " << capture_ahead_;
+    return true;
+}
+
+bool ControllerMgr::set_recording(MaaOptionValue value, MaaOptionValueSize val_size)
+{
+    std::string_view dir(reinterpret_cast<char*>(value), val_size);
+
+    std::shared_ptr<SessionRecorder> rec;
+    if (!dir.empty()) {
+        rec = std::make_shared<SessionRecorder>(MAA_NS::path(dir));
+        if (!rec->is_open()) {
+            LogError << "failed to start recording" << VAR(dir);
+            return false;
+        }
+        if (connected_) {
+            // 连接之后才开始录的，补一条分辨率
+            auto [res_w, res_h] = _get_resolution();
+            rec->record_resolution(res_w, res_h);
+        }
+    }
+
+    std::unique_lock lock { recorder_mutex_ };
+    recorder_ = std::move(rec);
+
+    LogInfo << "recording = " << dir;
+    return true;
+}
+
+bool ControllerMgr::set_parallel_lanes(MaaOptionValue value, MaaOptionValueSize val_size)
+{
+    if (val_size != sizeof(MaaBool)) {
+        LogError << "invalid value size: " << val_size;
+        return false;
+    }
+    bool parallel = *reinterpret_cast<MaaBool*>(value);
+    if (parallel && !_support_parallel_lanes()) {
+        LogError << "controller does not support parallel lanes";
+        return false;
+    }
+
+    // 已经排着的按原来的方式做完再切；预截图线程下次截图时会再起来
+    stop_capture_ahead();
+    wait_all();
+    parallel_lanes_ = parallel;
+
+    LogInfo << "parallel_lanes_ = " << parallel_lanes_;
+    return true;
+}
+
+cv::Mat ControllerMgr::record_screencap(Frame::Clock::time_point capture_time)
+{
+    cv::Mat raw = _screencap();
+    if (auto rec = recorder()) {
+        rec->record_frame(raw, capture_time);
+    }
+    return raw;
+}
+
+std::shared_ptr<SessionRecorder> ControllerMgr::recorder() const
+{
+    std::unique_lock lock { recorder_mutex_ };
+    return recorder_;
+}
+
+Frame ControllerMgr::screencap_ahead()
+{
+    start_capture_ahead();
+
+    Frame image;
+    cv::Mat raw;
+    {
+        std::unique_lock lock { ahead_mutex_ };
+        // 只要比上次取走的新、且是在最后一个动作之后开始截的，就直接拿，不用等
+        ahead_cond_.wait(lock, [&]() {
+            const auto& ready = ahead_frames_[ahead_ready_];
+            return ahead_exit_ || (ready.id() > ahead_consumed_id_ && ready.capture_time() >= last_action_time_);
+        });
+        if (ahead_exit_) {
+            return {};
+        }
+
+        std::swap(ahead_read_, ahead_ready_);
+        image = ahead_frames_[ahead_read_];
+        raw = ahead_raws_[ahead_read_];
+        ahead_consumed_id_ = image.id();
+    }
+
+    if (image.empty()) {
+        LogError << "Capture ahead failed";
+        return {};
+    }
+
+    // 后台截了但没被取走的帧不记，回放时一帧一帧对得上任务当时看到的
+    if (auto rec = recorder()) {
+        rec->record_frame(raw, image.capture_time());
+    }
+
+    std::unique_lock lock { image_mutex_ };
+    image_ = image;
+    return image;
+}
+
+void ControllerMgr::start_capture_ahead()
+{
+    std::unique_lock lock { ahead_thread_mutex_ };
+    if (ahead_thread_.joinable()) {
+        return;
+    }
+    LogFunc;
+
+    ahead_exit_ = false;
+    ahead_thread_ = std::thread(&ControllerMgr::capture_ahead_working, this);
+}
+
+void ControllerMgr::stop_capture_ahead()
+{
+    std::unique_lock thread_lock { ahead_thread_mutex_ };
+    if (!ahead_thread_.joinable()) {
+        return;
+    }
+    LogFunc;
+
+    {
+        std::unique_lock lock { ahead_mutex_ };
+        ahead_exit_ = true;
+    }
+    ahead_cond_.notify_all();
+    ahead_thread_.join();
+}
+
+void ControllerMgr::capture_ahead_working()
+{
+    LogFunc;
+
+    using namespace std::chrono_literals;
+
+    while (!ahead_exit_) {
+        auto capture_time = Frame::Clock::now();
+        auto& frame = ahead_frames_[ahead_write_];
+        auto& raw = ahead_raws_[ahead_write_];
+
+        bool ret = false;
+        {
+            auto ctrl_lock = lock_controller(Action::Type::screencap);
+            std::unique_lock lock { screencap_mutex_ };
+            raw = _screencap();
+            ret = postproc_screenshot(raw, capture_time, frame);
+        }
+        if (!ret) {
+            // 失败也要交出去一帧空图，不然消费者会一直等
+            frame = Frame(cv::Mat(), ++frame_id_, capture_time);
+            raw = cv::Mat();
+        }
+
+        {
+            std::unique_lock lock { ahead_mutex_ };
+            std::swap(ahead_write_, ahead_ready_);
+        }
+        ahead_cond_.notify_all();
+
+        if (!ret) {
+            std::this_thread::sleep_for(100ms);
+        }
+    }
+}
+
 std::ostream& operator<<(std::ostream& os, const Action& action)
 {
     switch (action.type) {
@@ -464,6 +936,21 @@ std::ostream& operator<<(std::ostream& os, const Action& action)
     case Action::Type::swipe:
         os << "swipe";
         break;
+    case Action::Type::touch_down:
+        os << "touch_down";
+        break;
+    case Action::Type::touch_move:
+        os << "touch_move";
+        break;
+    case Action::Type::touch_up:
+        os << "touch_up";
+        break;
+    case Action::Type::gesture:
+        os << "gesture";
+        break;
+    case Action::Type::press_key:
+        os << "press_key";
+        break;
     case Action::Type::screencap:
         os << "screencap";
         break;
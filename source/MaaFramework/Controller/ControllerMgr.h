@@ -2,15 +2,26 @@
 
 #include "API/MaaTypes.h"
 #include "Base/AsyncRunner.hpp"
+#include "Base/Frame.h"
 #include "Base/MessageNotifier.hpp"
+#include "ControlUnit/ControlUnitAPI.h"
 #include "Instance/InstanceInternalAPI.hpp"
 #include "Utils/NoWarningCVMat.hpp"
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <random>
 #include <set>
+#include <shared_mutex>
+#include <thread>
 #include <variant>
+#include <vector>
 
 MAA_RES_NS_BEGIN
 class ResourceMgr;
@@ -18,6 +29,8 @@ MAA_RES_NS_END
 
 MAA_CTRL_NS_BEGIN
 
+class SessionRecorder;
+
 struct ClickParam
 {
     int x = 0;
@@ -46,8 +59,28 @@ struct AppParam
 {
     std::string package;
 };
+struct GestureParam
+{
+    struct Event
+    {
+        enum class Type
+        {
+            down,
+            move,
+            up,
+        } type = Type::move;
+
+        int contact = 0;
+        int x = 0;
+        int y = 0;
+        int pressure = 0;
+        int time = 0; // 相对手势开始的毫秒数
+    };
+
+    std::vector<Event> events;
+};
 
-using Param = std::variant<std::monostate, ClickParam, SwipeParam, TouchParam, PressKeyParam, AppParam>;
+using Param = std::variant<std::monostate, ClickParam, SwipeParam, TouchParam, PressKeyParam, AppParam, GestureParam>;
 
 struct Action
 {
@@ -59,6 +92,7 @@ struct Action
         touch_down,
         touch_move,
         touch_up,
+        gesture,
         press_key,
         screencap,
         start_app,
@@ -88,12 +122,16 @@ public:
     virtual MaaCtrlId post_touch_down(int contact, int x, int y, int pressure) override;
     virtual MaaCtrlId post_touch_move(int contact, int x, int y, int pressure) override;
     virtual MaaCtrlId post_touch_up(int contact) override;
+    virtual MaaCtrlId post_gesture(const std::string& events) override;
 
     virtual MaaStatus status(MaaCtrlId ctrl_id) const override;
     virtual MaaStatus wait(MaaCtrlId ctrl_id) const override;
+    virtual void wait_all() const override;
     virtual MaaBool connected() const override;
 
     virtual cv::Mat get_image() const override;
+    virtual std::optional<std::vector<cv::Rect>> get_changed_regions() const override;
+    virtual std::optional<std::string> get_screencap_stats() const override;
     virtual std::string get_uuid() const override = 0;
 
     virtual void on_stop() override;
@@ -104,7 +142,7 @@ public:
     bool swipe(const cv::Rect& r1, const cv::Rect& r2, int duration);
     bool swipe(const cv::Point& p1, const cv::Point& p2, int duration);
     bool press_key(int keycode);
-    cv::Mat screencap();
+    Frame screencap();
 
     bool start_app();
     bool stop_app();
@@ -119,28 +157,77 @@ protected:
     virtual bool _touch_down(TouchParam param) = 0;
     virtual bool _touch_move(TouchParam param) = 0;
     virtual bool _touch_up(TouchParam param) = 0;
+    // 默认按 time 逐个调 _touch_*，能一次下发整段手势的自己重写
+    virtual bool _gesture(GestureParam param);
     virtual bool _press_key(PressKeyParam param) = 0;
     virtual cv::Mat _screencap() = 0;
+    // 截图端能直接输出目标大小的话，可以省掉一次整帧缩放；0 表示恢复原始大小
+    virtual void _set_screencap_target_size(int width, int height)
+    {
+        std::ignore = width;
+        std::ignore = height;
+    }
+    // 截图和输入能被两个线程同时调用时才返回 true，之后调用方才能用 MaaCtrlOption_ParallelLanes 打开分通道
+    // 连接、启停应用始终和其他调用互斥
+    virtual bool _support_parallel_lanes() const { return false; }
+    // 紧接着 _screencap 调用，返回那张图相对上一张变了的区域；不知道就返回 nullopt
+    virtual std::optional<std::vector<cv::Rect>> _screencap_changed_regions() const { return std::nullopt; }
+    // 会自动选截图方式的控制器返回当前方式和各方式的统计，格式见 MaaControllerGetScreencapStats
+    virtual std::optional<json::value> _screencap_stats() const { return std::nullopt; }
     virtual bool _start_app(AppParam param) = 0;
     virtual bool _stop_app(AppParam param) = 0;
 
+protected:
+    static std::vector<MAA_CTRL_UNIT_NS::TouchEvent> to_touch_events(const GestureParam& param);
+
 protected:
     MessageNotifier<MaaControllerCallback> notifier;
 
 private:
+    // 默认所有动作都在 app_lane_ 里按提交顺序执行
+    // 打开 parallel_lanes_ 后截图、输入、应用管理各走各的队列，每条队列内部有序，互相之间不等
+    // 要求输入做完再截图的，等输入的 id 或者 wait_all
+    struct Lane
+    {
+        std::unique_ptr<AsyncRunner<Action>> runner;
+        MaaCtrlId last_id = 0; // post_ids_mutex_
+    };
+
+    // 分通道时截图和输入拿共享锁，其余情况都独占
+    using ControllerLock = std::variant<std::shared_lock<std::shared_mutex>, std::unique_lock<std::shared_mutex>>;
+
     static cv::Point rand_point(const cv::Rect& r);
 
+    Lane& lane_of(Action::Type type);
+    const Lane* find_lane(MaaCtrlId id) const;
+    MaaCtrlId post(Action action, bool notify, bool block = false);
+    void release_lanes();
+    ControllerLock lock_controller(Action::Type type);
+
     bool run_action(typename AsyncRunner<Action>::Id id, Action action);
     std::pair<int, int> preproc_touch_point(int x, int y);
-    bool postproc_screenshot(const cv::Mat& raw);
+    std::optional<GestureParam> parse_gesture(const std::string& events);
+    bool postproc_screenshot(const cv::Mat& raw, Frame::Clock::time_point capture_time, /*out*/ Frame& output);
+    std::pair<int, int> image_target_size() const;
     bool check_and_calc_target_image_size(const cv::Mat& raw);
     void clear_target_image_size();
 
+    cv::Mat record_screencap(Frame::Clock::time_point capture_time);
+    std::shared_ptr<SessionRecorder> recorder() const;
+
+    Frame screencap_ahead();
+    void start_capture_ahead();
+    void stop_capture_ahead();
+    void capture_ahead_working();
+
 private: // options
     bool set_image_target_long_side(MaaOptionValue value, MaaOptionValueSize val_size);
     bool set_image_target_short_side(MaaOptionValue value, MaaOptionValueSize val_size);
     bool set_default_app_package_entry(MaaOptionValue value, MaaOptionValueSize val_size);
     bool set_default_app_package(MaaOptionValue value, MaaOptionValueSize val_size);
+    bool set_capture_ahead(MaaOptionValue value, MaaOptionValueSize val_size);
+    bool set_recording(MaaOptionValue value, MaaOptionValueSize val_size);
+    bool set_parallel_lanes(MaaOptionValue value, MaaOptionValueSize val_size);
 
 private:
     // InstanceInternalAPI* inst_ = nullptr;
@@ -148,21 +235,55 @@ private:
 private:
     static std::minstd_rand rand_engine_;
 
-    bool connected_ = false;
-    std::mutex image_mutex_;
-    cv::Mat image_;
+    std::atomic_bool connected_ = false;
+    mutable std::mutex image_mutex_;
+    Frame image_;
+    std::atomic<uint64_t> frame_id_ = 0;
+    // 串行化 _screencap，截图 action 和预截图线程不能同时调用
+    std::mutex screencap_mutex_;
 
+    // 设置项、截图线程、提交动作的线程都会读写，都在 target_size_mutex_ 里
     int image_target_long_side_ = 0;
     int image_target_short_side_ = 720;
     int image_target_width_ = 0;
     int image_target_height_ = 0;
+    mutable std::mutex target_size_mutex_;
 
     std::string default_app_package_entry_;
     std::string default_app_package_;
 
+    // 三缓冲：采集线程只写 write，消费者只读 read，二者通过 ready 交换
+    std::atomic_bool capture_ahead_ = false;
+    std::array<Frame, 3> ahead_frames_;
+    std::array<cv::Mat, 3> ahead_raws_; // 和 ahead_frames_ 一一对应，取走时才交给录制
+    size_t ahead_write_ = 0;
+    size_t ahead_ready_ = 1;
+    size_t ahead_read_ = 2;
+    uint64_t ahead_consumed_id_ = 0;
+    std::chrono::steady_clock::time_point last_action_time_;
+    std::mutex ahead_mutex_;
+    std::condition_variable ahead_cond_;
+    std::atomic_bool ahead_exit_ = false;
+    std::thread ahead_thread_;
+    std::mutex ahead_thread_mutex_; // 只管 ahead_thread_ 的启停
+
+    // 录制中的会话，空指针表示没在录
+    std::shared_ptr<SessionRecorder> recorder_;
+    mutable std::mutex recorder_mutex_;
+
     std::set<AsyncRunner<Action>::Id> post_ids_;
-    std::mutex post_ids_mutex_;
-    std::unique_ptr<AsyncRunner<Action>> action_runner_ = nullptr;
+    mutable std::mutex post_ids_mutex_;
+
+    // 其他通道的动作要等连接完成
+    std::atomic<MaaCtrlId> connect_id_ = 0;
+
+    std::atomic_bool parallel_lanes_ = false;
+    // 串行化对控制器的调用，见 lock_controller
+    std::shared_mutex controller_mutex_;
+
+    Lane capture_lane_;
+    Lane input_lane_;
+    Lane app_lane_;
 };
 
 MAA_CTRL_NS_END
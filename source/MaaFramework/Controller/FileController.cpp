@@ -0,0 +1,212 @@
+#include "FileController.h"
+
+#include <meojson/json.hpp>
+
+#include "FrameSource.h"
+#include "Utils/Logger.h"
+#include "Utils/Platform.h"
+
+MAA_CTRL_NS_BEGIN
+
+FileController::FileController(Source source, const std::string& path, const std::string& config,
+                               MaaControllerCallback callback, MaaCallbackTransparentArg callback_arg)
+    : ControllerMgr(callback, callback_arg)
+{
+    LogDebug << VAR(path) << VAR(config);
+
+    json::value config_json = json::object();
+    if (!config.empty()) {
+        auto config_opt = json::parse(config);
+        if (!config_opt || !config_opt->is_object()) {
+            LogError << "Invalid config: " << config;
+            throw std::runtime_error("MaaFileController: Invalid config");
+        }
+        config_json = *config_opt;
+    }
+
+    queue_size_ = std::max(1, config_json.get("queue_size", static_cast<int>(queue_size_)));
+    loop_ = config_json.get("loop", loop_);
+
+    switch (source) {
+    case Source::Video:
+        source_ = std::make_unique<VideoFrameSource>(MAA_NS::path(path), config_json);
+        break;
+    case Source::ImageDir:
+        source_ = std::make_unique<ImageDirFrameSource>(MAA_NS::path(path));
+        break;
+    }
+}
+
+FileController::~FileController()
+{
+    // 预取线程在用 source_，要先停
+    stop_prefetch();
+}
+
+std::string FileController::get_uuid() const
+{
+    return "file:" + source_->name();
+}
+
+bool FileController::_connect()
+{
+    LogFunc << VAR(source_->name()) << VAR(queue_size_) << VAR(loop_);
+
+    stop_prefetch();
+
+    if (!source_->open()) {
+        return false;
+    }
+
+    cv::Mat first = source_->read();
+    if (first.empty()) {
+        LogError << "no frame in source" << VAR(source_->name());
+        return false;
+    }
+    width_ = first.cols;
+    height_ = first.rows;
+
+    start_prefetch(std::move(first));
+    return true;
+}
+
+std::pair<int, int> FileController::_get_resolution() const
+{
+    return { width_, height_ };
+}
+
+bool FileController::_click(ClickParam param)
+{
+    LogInfo << "ignored" << VAR(param.x) << VAR(param.y);
+    return true;
+}
+
+bool FileController::_swipe(SwipeParam param)
+{
+    LogInfo << "ignored" << VAR(param.x1) << VAR(param.y1) << VAR(param.x2) << VAR(param.y2) << VAR(param.duration);
+    return true;
+}
+
+bool FileController::_touch_down(TouchParam param)
+{
+    LogInfo << "ignored" << VAR(param.contact) << VAR(param.x) << VAR(param.y) << VAR(param.pressure);
+    return true;
+}
+
+bool FileController::_touch_move(TouchParam param)
+{
+    LogInfo << "ignored" << VAR(param.contact) << VAR(param.x) << VAR(param.y) << VAR(param.pressure);
+    return true;
+}
+
+bool FileController::_touch_up(TouchParam param)
+{
+    LogInfo << "ignored" << VAR(param.contact);
+    return true;
+}
+
+bool FileController::_gesture(GestureParam param)
+{
+    LogInfo << "ignored" << VAR(param.events.size());
+    return true;
+}
+
+bool FileController::_press_key(PressKeyParam param)
+{
+    LogInfo << "ignored" << VAR(param.keycode);
+    return true;
+}
+
+cv::Mat FileController::_screencap()
+{
+    std::unique_lock lock { queue_mutex_ };
+    queue_cond_.wait(lock, [&]() { return !queue_.empty() || source_end_ || prefetch_exit_; });
+
+    if (queue_.empty()) {
+        LogError << "no more frames" << VAR(source_->name());
+        return {};
+    }
+
+    cv::Mat frame = std::move(queue_.front());
+    queue_.pop_front();
+    lock.unlock();
+
+    queue_cond_.notify_all();
+    return frame;
+}
+
+bool FileController::_start_app(AppParam param)
+{
+    LogInfo << "ignored" << VAR(param.package);
+    return true;
+}
+
+bool FileController::_stop_app(AppParam param)
+{
+    LogInfo << "ignored" << VAR(param.package);
+    return true;
+}
+
+void FileController::start_prefetch(cv::Mat first)
+{
+    LogFunc;
+
+    {
+        std::unique_lock lock { queue_mutex_ };
+        queue_.clear();
+        queue_.emplace_back(std::move(first));
+        source_end_ = false;
+    }
+
+    prefetch_exit_ = false;
+    prefetch_thread_ = std::thread(&FileController::prefetch_working, this);
+}
+
+void FileController::stop_prefetch()
+{
+    if (!prefetch_thread_.joinable()) {
+        return;
+    }
+    LogFunc;
+
+    {
+        std::unique_lock lock { queue_mutex_ };
+        prefetch_exit_ = true;
+    }
+    queue_cond_.notify_all();
+    prefetch_thread_.join();
+}
+
+void FileController::prefetch_working()
+{
+    LogFunc;
+
+    while (!prefetch_exit_) {
+        cv::Mat frame = source_->read();
+
+        if (frame.empty() && loop_ && source_->open()) {
+            frame = source_->read();
+        }
+        if (frame.empty()) {
+            LogInfo << "source end" << VAR(source_->name());
+            {
+                std::unique_lock lock { queue_mutex_ };
+                source_end_ = true;
+            }
+            queue_cond_.notify_all();
+            return;
+        }
+
+        std::unique_lock lock { queue_mutex_ };
+        queue_cond_.wait(lock, [&]() { return queue_.size() < queue_size_ || prefetch_exit_; });
+        if (prefetch_exit_) {
+            return;
+        }
+        queue_.emplace_back(std::move(frame));
+        lock.unlock();
+
+        queue_cond_.notify_all();
+    }
+}
+
+MAA_CTRL_NS_END
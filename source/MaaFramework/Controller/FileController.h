@@ -0,0 +1,71 @@
+#pragma once
+
+#include "ControllerMgr.h"
+
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+
+MAA_CTRL_NS_BEGIN
+
+class FrameSource;
+
+// 从视频文件或者图片目录取帧，给离线跑识别用
+// 后台线程提前解码到有界队列里，_screencap 只取队首；动作都不做，只打日志
+// config: { "queue_size": 8, "loop": false, "step": 1 }
+//   loop: 读完了从头再来；否则之后的截图都失败
+//   step: 只对视频有效，每 step 帧取一帧
+// 分辨率取第一帧的大小，后面大小不一样的帧也会被缩放到同样的目标大小
+class FileController : public ControllerMgr
+{
+public:
+    enum class Source
+    {
+        Video,
+        ImageDir,
+    };
+
+public:
+    FileController(Source source, const std::string& path, const std::string& config,
+                   MaaControllerCallback callback, MaaCallbackTransparentArg callback_arg);
+    virtual ~FileController() override;
+
+    virtual std::string get_uuid() const override;
+
+protected:
+    virtual bool _connect() override;
+    virtual std::pair<int, int> _get_resolution() const override;
+    virtual bool _click(ClickParam param) override;
+    virtual bool _swipe(SwipeParam param) override;
+    virtual bool _touch_down(TouchParam param) override;
+    virtual bool _touch_move(TouchParam param) override;
+    virtual bool _touch_up(TouchParam param) override;
+    virtual bool _gesture(GestureParam param) override;
+    virtual bool _press_key(PressKeyParam param) override;
+    virtual cv::Mat _screencap() override;
+    virtual bool _start_app(AppParam param) override;
+    virtual bool _stop_app(AppParam param) override;
+
+private:
+    void start_prefetch(cv::Mat first);
+    void stop_prefetch();
+    void prefetch_working();
+
+    std::unique_ptr<FrameSource> source_;
+    size_t queue_size_ = 8;
+    bool loop_ = false;
+
+    int width_ = 0;
+    int height_ = 0;
+
+    std::deque<cv::Mat> queue_;
+    bool source_end_ = false;
+    std::mutex queue_mutex_;
+    std::condition_variable queue_cond_;
+    std::atomic_bool prefetch_exit_ = false;
+    std::thread prefetch_thread_;
+};
+
+MAA_CTRL_NS_END
@@ -0,0 +1,107 @@
+#include "FrameSource.h"
+
+#include <algorithm>
+#include <cctype>
+#include <unordered_set>
+
+#include "Utils/ImageIo.h"
+#include "Utils/Logger.h"
+#include "Utils/NoWarningCV.hpp"
+#include "Utils/Platform.h"
+
+MAA_CTRL_NS_BEGIN
+
+VideoFrameSource::VideoFrameSource(std::filesystem::path path, const json::value& config)
+    : path_(std::move(path)), capture_(std::make_unique<cv::VideoCapture>())
+{
+    step_ = std::max(1, config.get("step", 1));
+}
+
+VideoFrameSource::~VideoFrameSource() = default;
+
+bool VideoFrameSource::open()
+{
+    LogFunc << VAR(path_) << VAR(step_);
+
+    if (!capture_->open(path_to_utf8_string(path_))) {
+        LogError << "failed to open video" << VAR(path_);
+        return false;
+    }
+
+    LogInfo << "video opened" << VAR(capture_->get(cv::CAP_PROP_FRAME_COUNT)) << VAR(capture_->get(cv::CAP_PROP_FPS));
+    return true;
+}
+
+cv::Mat VideoFrameSource::read()
+{
+    // 跳过的帧只 grab，不用解码
+    for (int i = 1; i < step_; ++i) {
+        if (!capture_->grab()) {
+            return {};
+        }
+    }
+
+    cv::Mat frame;
+    if (!capture_->read(frame)) {
+        return {};
+    }
+    return frame;
+}
+
+std::string VideoFrameSource::name() const
+{
+    return path_to_utf8_string(path_);
+}
+
+ImageDirFrameSource::ImageDirFrameSource(std::filesystem::path dir) : dir_(std::move(dir)) {}
+
+bool ImageDirFrameSource::open()
+{
+    LogFunc << VAR(dir_);
+
+    static const std::unordered_set<std::string> kExtensions = { ".png", ".jpg", ".jpeg", ".bmp", ".webp" };
+
+    files_.clear();
+    index_ = 0;
+
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(dir_, ec)) {
+        if (!entry.is_regular_file()) {
+            continue;
+        }
+        auto ext = path_to_utf8_string(entry.path().extension());
+        std::ranges::transform(ext, ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (kExtensions.contains(ext)) {
+            files_.emplace_back(entry.path());
+        }
+    }
+    if (ec) {
+        LogError << "failed to list dir" << VAR(dir_) << VAR(ec.message());
+        return false;
+    }
+
+    std::ranges::sort(files_);
+    LogInfo << VAR(files_.size());
+    return !files_.empty();
+}
+
+cv::Mat ImageDirFrameSource::read()
+{
+    while (index_ < files_.size()) {
+        const auto& file = files_[index_++];
+        cv::Mat image = MAA_NS::imread(file);
+        if (!image.empty()) {
+            return image;
+        }
+        // 坏图跳过，不当作结束
+        LogWarn << "failed to read image" << VAR(file);
+    }
+    return {};
+}
+
+std::string ImageDirFrameSource::name() const
+{
+    return path_to_utf8_string(dir_);
+}
+
+MAA_CTRL_NS_END
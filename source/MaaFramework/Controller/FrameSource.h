@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Conf/Conf.h"
+#include "Utils/NoWarningCVMat.hpp"
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <meojson/json.hpp>
+
+namespace cv
+{
+class VideoCapture;
+}
+
+MAA_CTRL_NS_BEGIN
+
+// FileController 的帧来源，只在预取线程里用，不需要加锁
+class FrameSource
+{
+public:
+    virtual ~FrameSource() = default;
+
+    // 从头开始，loop 时也会再调一次
+    virtual bool open() = 0;
+    // 读完了返回空
+    virtual cv::Mat read() = 0;
+    virtual std::string name() const = 0;
+};
+
+// config: { "step": 1 }，每 step 帧取一帧，其余只 grab 不解码
+class VideoFrameSource : public FrameSource
+{
+public:
+    VideoFrameSource(std::filesystem::path path, const json::value& config);
+    virtual ~VideoFrameSource() override;
+
+    virtual bool open() override;
+    virtual cv::Mat read() override;
+    virtual std::string name() const override;
+
+private:
+    std::filesystem::path path_;
+    int step_ = 1;
+    std::unique_ptr<cv::VideoCapture> capture_;
+};
+
+// 目录下的图片按文件名排序逐张读，不递归子目录
+class ImageDirFrameSource : public FrameSource
+{
+public:
+    explicit ImageDirFrameSource(std::filesystem::path dir);
+    virtual ~ImageDirFrameSource() override = default;
+
+    virtual bool open() override;
+    virtual cv::Mat read() override;
+    virtual std::string name() const override;
+
+private:
+    std::filesystem::path dir_;
+    std::vector<std::filesystem::path> files_;
+    size_t index_ = 0;
+};
+
+MAA_CTRL_NS_END
@@ -0,0 +1,284 @@
+#include "ReplayController.h"
+
+#include <fstream>
+
+#include "SessionRecorder.h"
+#include "Utils/ImageIo.h"
+#include "Utils/Logger.h"
+#include "Utils/Platform.h"
+
+MAA_CTRL_NS_BEGIN
+
+ReplayController::ReplayController(const std::string& config, MaaControllerCallback callback,
+                                   MaaCallbackTransparentArg callback_arg)
+    : ControllerMgr(callback, callback_arg)
+{
+    LogDebug << VAR(config);
+
+    auto config_json = json::parse(config);
+    if (!config_json || !config_json->is_object()) {
+        LogError << "Invalid config: " << config;
+        throw std::runtime_error("MaaReplayController: Invalid config");
+    }
+
+    session_dir_ = MAA_NS::path(config_json->get("session", std::string()));
+    tolerance_ = config_json->get("tolerance", tolerance_);
+
+    auto mode = config_json->get("mode", std::string("sequential"));
+    if (mode == "sequential") {
+        mode_ = Mode::Sequential;
+    }
+    else if (mode == "action") {
+        mode_ = Mode::Action;
+    }
+    else {
+        LogError << "Invalid mode: " << mode;
+        throw std::runtime_error("MaaReplayController: Invalid mode");
+    }
+
+    if (!load_session()) {
+        throw std::runtime_error("MaaReplayController: Failed to load session");
+    }
+
+    if (auto output = config_json->get("output", std::string()); !output.empty()) {
+        output_ = std::make_unique<SessionRecorder>(MAA_NS::path(output), false);
+    }
+}
+
+ReplayController::~ReplayController() = default;
+
+std::string ReplayController::get_uuid() const
+{
+    return "replay:" + path_to_utf8_string(session_dir_);
+}
+
+bool ReplayController::_connect()
+{
+    LogFunc << VAR(session_dir_) << VAR(frames_.size()) << VAR(steps_.size());
+
+    std::unique_lock lock { mutex_ };
+    cursor_ = 0;
+    step_ = 0;
+    return !frames_.empty();
+}
+
+std::pair<int, int> ReplayController::_get_resolution() const
+{
+    return { width_, height_ };
+}
+
+bool ReplayController::_click(ClickParam param)
+{
+    return on_action({ .type = Action::Type::click, .param = param });
+}
+
+bool ReplayController::_swipe(SwipeParam param)
+{
+    return on_action({ .type = Action::Type::swipe, .param = param });
+}
+
+bool ReplayController::_touch_down(TouchParam param)
+{
+    return on_action({ .type = Action::Type::touch_down, .param = param });
+}
+
+bool ReplayController::_touch_move(TouchParam param)
+{
+    return on_action({ .type = Action::Type::touch_move, .param = param });
+}
+
+bool ReplayController::_touch_up(TouchParam param)
+{
+    return on_action({ .type = Action::Type::touch_up, .param = param });
+}
+
+bool ReplayController::_gesture(GestureParam param)
+{
+    return on_action({ .type = Action::Type::gesture, .param = std::move(param) });
+}
+
+bool ReplayController::_press_key(PressKeyParam param)
+{
+    return on_action({ .type = Action::Type::press_key, .param = param });
+}
+
+cv::Mat ReplayController::_screencap()
+{
+    std::unique_lock lock { mutex_ };
+
+    if (frames_.empty()) {
+        LogError << "No frame to replay";
+        return {};
+    }
+
+    size_t index = std::min(cursor_, frames_.size() - 1);
+    if (mode_ == Mode::Sequential) {
+        if (cursor_ + 1 < frames_.size()) {
+            ++cursor_;
+        }
+    }
+    else if (cursor_ + 1 < segment_end()) {
+        ++cursor_;
+    }
+
+    if (index != cached_index_) {
+        cached_image_ = MAA_NS::imread(frames_[index]);
+        cached_index_ = index;
+    }
+    if (cached_image_.empty()) {
+        LogError << "Failed to read frame" << VAR(frames_[index]);
+    }
+    return cached_image_;
+}
+
+bool ReplayController::_start_app(AppParam param)
+{
+    return on_action({ .type = Action::Type::start_app, .param = std::move(param) });
+}
+
+bool ReplayController::_stop_app(AppParam param)
+{
+    return on_action({ .type = Action::Type::stop_app, .param = std::move(param) });
+}
+
+bool ReplayController::load_session()
+{
+    LogFunc << VAR(session_dir_);
+
+    std::ifstream ifs(session_dir_ / SessionRecorder::kSessionFile, std::ios::in);
+    if (!ifs.is_open()) {
+        LogError << "failed to open session" << VAR(session_dir_);
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(ifs, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        auto record_opt = json::parse(line);
+        if (!record_opt || !record_opt->is_object()) {
+            LogWarn << "invalid record" << VAR(line);
+            continue;
+        }
+        const auto& record = *record_opt;
+
+        auto type = record.get("type", std::string());
+        if (type == "resolution") {
+            width_ = record.get("width", 0);
+            height_ = record.get("height", 0);
+            continue;
+        }
+        if (type == "screencap") {
+            frames_.emplace_back(session_dir_ / MAA_NS::path(record.get("file", std::string())));
+            continue;
+        }
+
+        auto action_opt = SessionRecorder::from_json(record);
+        if (!action_opt || action_opt->type == Action::Type::connect) {
+            continue;
+        }
+        steps_.emplace_back(Step { .action = std::move(*action_opt), .frame_index = frames_.size() });
+    }
+
+    if (frames_.empty()) {
+        LogError << "no frame in session" << VAR(session_dir_);
+        return false;
+    }
+
+    if (width_ == 0 || height_ == 0) {
+        // 没录到分辨率的话，就当作和第一帧一样大
+        cv::Mat first = MAA_NS::imread(frames_.front());
+        width_ = first.cols;
+        height_ = first.rows;
+    }
+
+    LogInfo << VAR(frames_.size()) << VAR(steps_.size()) << VAR(width_) << VAR(height_);
+    return width_ > 0 && height_ > 0;
+}
+
+bool ReplayController::on_action(const Action& action)
+{
+    if (output_) {
+        output_->record_action(action, true);
+    }
+
+    if (mode_ != Mode::Action) {
+        return true;
+    }
+
+    std::unique_lock lock { mutex_ };
+    for (size_t i = step_; i < steps_.size(); ++i) {
+        if (!match(steps_[i].action, action)) {
+            continue;
+        }
+        if (i != step_) {
+            LogWarn << "skip recorded actions" << VAR(step_) << VAR(i);
+        }
+        cursor_ = steps_[i].frame_index;
+        step_ = i + 1;
+        return true;
+    }
+
+    LogWarn << "no recorded action matches, stay at current frames" << VAR(action) << VAR(step_) << VAR(cursor_);
+    return true;
+}
+
+bool ReplayController::match(const Action& recorded, const Action& received) const
+{
+    if (recorded.type != received.type || recorded.param.index() != received.param.index()) {
+        return false;
+    }
+
+    auto within = [&](int lhs, int rhs) {
+        return std::abs(lhs - rhs) <= tolerance_;
+    };
+
+    return std::visit(
+        [&](const auto& lhs) {
+            using T = std::decay_t<decltype(lhs)>;
+            const auto& rhs = std::get<T>(received.param);
+            if constexpr (std::is_same_v<T, ClickParam>) {
+                return within(lhs.x, rhs.x) && within(lhs.y, rhs.y);
+            }
+            else if constexpr (std::is_same_v<T, SwipeParam>) {
+                return within(lhs.x1, rhs.x1) && within(lhs.y1, rhs.y1) && within(lhs.x2, rhs.x2) &&
+                       within(lhs.y2, rhs.y2);
+            }
+            else if constexpr (std::is_same_v<T, TouchParam>) {
+                // touch_up 不带坐标
+                return lhs.contact == rhs.contact &&
+                       (recorded.type == Action::Type::touch_up || (within(lhs.x, rhs.x) && within(lhs.y, rhs.y)));
+            }
+            else if constexpr (std::is_same_v<T, PressKeyParam>) {
+                return lhs.keycode == rhs.keycode;
+            }
+            else if constexpr (std::is_same_v<T, AppParam>) {
+                return lhs.package == rhs.package;
+            }
+            else if constexpr (std::is_same_v<T, GestureParam>) {
+                if (lhs.events.size() != rhs.events.size()) {
+                    return false;
+                }
+                for (size_t i = 0; i < lhs.events.size(); ++i) {
+                    const auto& l = lhs.events[i];
+                    const auto& r = rhs.events[i];
+                    if (l.type != r.type || l.contact != r.contact || !within(l.x, r.x) || !within(l.y, r.y)) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+            else {
+                return true;
+            }
+        },
+        recorded.param);
+}
+
+size_t ReplayController::segment_end() const
+{
+    return step_ < steps_.size() ? steps_[step_].frame_index : frames_.size();
+}
+
+MAA_CTRL_NS_END
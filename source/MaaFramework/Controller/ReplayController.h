@@ -0,0 +1,83 @@
+#pragma once
+
+#include "ControllerMgr.h"
+
+#include <filesystem>
+
+#include <meojson/json.hpp>
+
+MAA_CTRL_NS_BEGIN
+
+class SessionRecorder;
+
+// 回放 SessionRecorder 录下的会话，不需要设备，可以在没有设备的机器上复现识别和任务流程
+// config: { "session": "path/to/session", "mode": "sequential", "tolerance": 20, "output": "path/to/dir" }
+//   mode:
+//     sequential: 按录制顺序每次截图给下一帧，放完了一直给最后一帧
+//     action:     帧按录制时的动作分段，截图只在当前段内往后走，收到和录制匹配的动作才跳到对应的段
+//   tolerance: action 模式下坐标允许的误差（像素，设备坐标），点击区域本身就带随机
+//   output: 收到的动作按同样的格式记到这个目录，方便和原录制对比；不给就只打日志
+class ReplayController : public ControllerMgr
+{
+public:
+    enum class Mode
+    {
+        Sequential,
+        Action,
+    };
+
+public:
+    ReplayController(const std::string& config, MaaControllerCallback callback,
+                     MaaCallbackTransparentArg callback_arg);
+    virtual ~ReplayController() override;
+
+    virtual std::string get_uuid() const override;
+
+protected:
+    virtual bool _connect() override;
+    virtual std::pair<int, int> _get_resolution() const override;
+    virtual bool _click(ClickParam param) override;
+    virtual bool _swipe(SwipeParam param) override;
+    virtual bool _touch_down(TouchParam param) override;
+    virtual bool _touch_move(TouchParam param) override;
+    virtual bool _touch_up(TouchParam param) override;
+    virtual bool _gesture(GestureParam param) override;
+    virtual bool _press_key(PressKeyParam param) override;
+    virtual cv::Mat _screencap() override;
+    virtual bool _start_app(AppParam param) override;
+    virtual bool _stop_app(AppParam param) override;
+
+private:
+    // 录制时的一个动作，以及它之后的第一帧
+    struct Step
+    {
+        Action action;
+        size_t frame_index = 0;
+    };
+
+    bool load_session();
+    bool on_action(const Action& action);
+    bool match(const Action& recorded, const Action& received) const;
+    size_t segment_end() const;
+
+    std::filesystem::path session_dir_;
+    Mode mode_ = Mode::Sequential;
+    int tolerance_ = 20;
+
+    int width_ = 0;
+    int height_ = 0;
+    std::vector<std::filesystem::path> frames_;
+    std::vector<Step> steps_;
+
+    std::mutex mutex_;
+    size_t cursor_ = 0; // 下一次截图给的帧
+    size_t step_ = 0;   // 下一个等着匹配的动作
+
+    // 连续截同一帧时不用重复解码
+    size_t cached_index_ = SIZE_MAX;
+    cv::Mat cached_image_;
+
+    std::unique_ptr<SessionRecorder> output_;
+};
+
+MAA_CTRL_NS_END
@@ -0,0 +1,301 @@
+#include "SessionRecorder.h"
+
+#include "Utils/Format.hpp"
+#include "Utils/ImageIo.h"
+#include "Utils/Logger.h"
+
+MAA_CTRL_NS_BEGIN
+
+static const std::map<Action::Type, std::string> kActionNames = {
+    { Action::Type::connect, "connect" },       { Action::Type::click, "click" },
+    { Action::Type::swipe, "swipe" },           { Action::Type::touch_down, "touch_down" },
+    { Action::Type::touch_move, "touch_move" }, { Action::Type::touch_up, "touch_up" },
+    { Action::Type::gesture, "gesture" },       { Action::Type::press_key, "press_key" },
+    { Action::Type::screencap, "screencap" },   { Action::Type::start_app, "start_app" },
+    { Action::Type::stop_app, "stop_app" },
+};
+
+static const std::map<GestureParam::Event::Type, std::string> kGestureEventNames = {
+    { GestureParam::Event::Type::down, "down" },
+    { GestureParam::Event::Type::move, "move" },
+    { GestureParam::Event::Type::up, "up" },
+};
+
+SessionRecorder::SessionRecorder(const std::filesystem::path& dir, bool record_frames)
+    : dir_(dir), record_frames_(record_frames), start_time_(Frame::Clock::now())
+{
+    LogFunc << VAR(dir) << VAR(record_frames);
+
+    std::error_code ec;
+    std::filesystem::create_directories(dir_, ec);
+    if (ec) {
+        LogError << "failed to create dir" << VAR(dir_) << VAR(ec.message());
+        return;
+    }
+
+    // 追加写，同一个目录可以接着录
+    ofs_ = std::ofstream(dir_ / kSessionFile, std::ios::out | std::ios::app);
+    if (!ofs_.is_open()) {
+        LogError << "failed to open session file" << VAR(dir_);
+        return;
+    }
+
+    // 接着录的时候帧序号不能和已有的撞上
+    if (record_frames_) {
+        auto frames_dir = dir_ / "frames";
+        if (std::filesystem::exists(frames_dir)) {
+            for (const auto& entry : std::filesystem::directory_iterator(frames_dir, ec)) {
+                std::ignore = entry;
+                ++frame_count_;
+            }
+        }
+    }
+
+    // 时间接着上次的往后走，回放时才不会倒退
+    start_time_ -= std::chrono::milliseconds(last_recorded_time());
+
+    writer_ = std::make_unique<AsyncRunner<Record>>(
+        [this](auto id, Record record) {
+            std::ignore = id;
+            return write(std::move(record));
+        });
+}
+
+SessionRecorder::~SessionRecorder()
+{
+    if (!writer_) {
+        return;
+    }
+
+    // 队列里剩下的都写完再退
+    AsyncRunner<Record>::Id last_id = MaaInvalidId;
+    {
+        std::unique_lock lock { post_mutex_ };
+        last_id = last_id_;
+    }
+    if (last_id != MaaInvalidId) {
+        writer_->wait(last_id);
+    }
+    writer_->release();
+}
+
+void SessionRecorder::record_resolution(int width, int height)
+{
+    post({ .line = {
+               { "type", "resolution" },
+               { "time", elapsed(Frame::Clock::now()) },
+               { "width", width },
+               { "height", height },
+           } });
+}
+
+void SessionRecorder::record_frame(const cv::Mat& raw, Frame::Clock::time_point capture_time)
+{
+    if (!record_frames_ || raw.empty()) {
+        return;
+    }
+
+    if (!writer_) {
+        return;
+    }
+
+    // raw 只是多一份引用，缓冲池在写完之前不会把它借给别人，所以排队的帧不能无限多
+    // 写不过来就丢，不能等，等了就拖慢截图了
+    std::unique_lock lock { post_mutex_ };
+    if (pending_frames_ >= kMaxPendingFrames) {
+        LogWarn << "recorder is falling behind, drop frame" << VAR(pending_frames_.load());
+        return;
+    }
+    ++pending_frames_;
+    std::string file = MAA_FMT::format("frames/{:06}.png", ++frame_count_);
+    last_id_ = writer_->post({ .line = {
+                                   { "type", "screencap" },
+                                   { "time", elapsed(capture_time) },
+                                   { "file", file },
+                               },
+                               .frame = raw });
+}
+
+void SessionRecorder::record_action(const Action& action, bool ret)
+{
+    auto record = to_json(action);
+    record["time"] = elapsed(Frame::Clock::now());
+    record["ret"] = ret;
+    post({ .line = std::move(record) });
+}
+
+json::object SessionRecorder::to_json(const Action& action)
+{
+    json::object record;
+    if (auto it = kActionNames.find(action.type); it != kActionNames.end()) {
+        record["type"] = it->second;
+    }
+
+    std::visit(
+        [&](const auto& param) {
+            using T = std::decay_t<decltype(param)>;
+            if constexpr (std::is_same_v<T, ClickParam>) {
+                record["x"] = param.x;
+                record["y"] = param.y;
+            }
+            else if constexpr (std::is_same_v<T, SwipeParam>) {
+                record["x1"] = param.x1;
+                record["y1"] = param.y1;
+                record["x2"] = param.x2;
+                record["y2"] = param.y2;
+                record["duration"] = param.duration;
+            }
+            else if constexpr (std::is_same_v<T, TouchParam>) {
+                record["contact"] = param.contact;
+                record["x"] = param.x;
+                record["y"] = param.y;
+                record["pressure"] = param.pressure;
+            }
+            else if constexpr (std::is_same_v<T, PressKeyParam>) {
+                record["keycode"] = param.keycode;
+            }
+            else if constexpr (std::is_same_v<T, AppParam>) {
+                record["package"] = param.package;
+            }
+            else if constexpr (std::is_same_v<T, GestureParam>) {
+                json::array events;
+                for (const auto& event : param.events) {
+                    events.emplace_back(json::object {
+                        { "type", kGestureEventNames.at(event.type) },
+                        { "contact", event.contact },
+                        { "x", event.x },
+                        { "y", event.y },
+                        { "pressure", event.pressure },
+                        { "time", event.time },
+                    });
+                }
+                record["events"] = std::move(events);
+            }
+        },
+        action.param);
+
+    return record;
+}
+
+std::optional<Action> SessionRecorder::from_json(const json::value& record)
+{
+    auto type_name = record.get("type", std::string());
+    auto it = std::ranges::find_if(kActionNames, [&](const auto& pair) { return pair.second == type_name; });
+    if (it == kActionNames.end()) {
+        return std::nullopt;
+    }
+
+    Action action { .type = it->first };
+    switch (action.type) {
+    case Action::Type::click:
+        action.param = ClickParam { .x = record.get("x", 0), .y = record.get("y", 0) };
+        break;
+    case Action::Type::swipe:
+        action.param = SwipeParam { .x1 = record.get("x1", 0),
+                                    .y1 = record.get("y1", 0),
+                                    .x2 = record.get("x2", 0),
+                                    .y2 = record.get("y2", 0),
+                                    .duration = record.get("duration", 0) };
+        break;
+    case Action::Type::touch_down:
+    case Action::Type::touch_move:
+    case Action::Type::touch_up:
+        action.param = TouchParam { .contact = record.get("contact", 0),
+                                    .x = record.get("x", 0),
+                                    .y = record.get("y", 0),
+                                    .pressure = record.get("pressure", 0) };
+        break;
+    case Action::Type::gesture: {
+        GestureParam param;
+        if (auto events_opt = record.find<json::array>("events")) {
+            for (const auto& event : *events_opt) {
+                auto type_name = event.get("type", std::string());
+                auto it = std::ranges::find_if(kGestureEventNames,
+                                               [&](const auto& pair) { return pair.second == type_name; });
+                if (it == kGestureEventNames.end()) {
+                    continue;
+                }
+                param.events.emplace_back(GestureParam::Event { .type = it->first,
+                                                                .contact = event.get("contact", 0),
+                                                                .x = event.get("x", 0),
+                                                                .y = event.get("y", 0),
+                                                                .pressure = event.get("pressure", 0),
+                                                                .time = event.get("time", 0) });
+            }
+        }
+        action.param = std::move(param);
+    } break;
+    case Action::Type::press_key:
+        action.param = PressKeyParam { .keycode = record.get("keycode", 0) };
+        break;
+    case Action::Type::start_app:
+    case Action::Type::stop_app:
+        action.param = AppParam { .package = record.get("package", std::string()) };
+        break;
+    default:
+        break;
+    }
+    return action;
+}
+
+int64_t SessionRecorder::elapsed(Frame::Clock::time_point time) const
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(time - start_time_).count();
+}
+
+int64_t SessionRecorder::last_recorded_time() const
+{
+    std::ifstream ifs(dir_ / kSessionFile, std::ios::in);
+    if (!ifs.is_open()) {
+        return 0;
+    }
+
+    int64_t last = 0;
+    std::string line;
+    while (std::getline(ifs, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        auto record_opt = json::parse(line);
+        if (!record_opt || !record_opt->is_object()) {
+            continue;
+        }
+        last = std::max(last, record_opt->get("time", int64_t(0)));
+    }
+    return last;
+}
+
+void SessionRecorder::post(Record record)
+{
+    if (!writer_) {
+        return;
+    }
+
+    std::unique_lock lock { post_mutex_ };
+    last_id_ = writer_->post(std::move(record));
+}
+
+bool SessionRecorder::write(Record record)
+{
+    if (!ofs_.is_open()) {
+        return false;
+    }
+
+    if (!record.frame.empty()) {
+        auto file = record.line["file"].as_string();
+        // png 无损，压缩等级调低一点，写线程跟得上截图
+        bool written = MAA_NS::imwrite(dir_ / MAA_NS::path(file), record.frame, { cv::IMWRITE_PNG_COMPRESSION, 1 });
+        record.frame.release();
+        --pending_frames_;
+        if (!written) {
+            LogError << "failed to write frame" << VAR(file);
+            return false;
+        }
+    }
+
+    // 一行一条，中途崩了也只丢最后一行
+    ofs_ << json::value(record.line).to_string() << std::endl;
+    return true;
+}
+
+MAA_CTRL_NS_END
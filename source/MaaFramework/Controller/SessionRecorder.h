@@ -0,0 +1,79 @@
+#pragma once
+
+#include "ControllerMgr.h"
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+#include "Base/AsyncRunner.hpp"
+
+#include <meojson/json.hpp>
+
+MAA_CTRL_NS_BEGIN
+
+// 把任务拿到的每一帧和执行的每个动作都记下来，给 ReplayController 离线回放用
+// 预截图时只记被取走的帧；写盘跟不上时会丢帧，并打日志
+// 目录结构：
+//   {dir}/session.jsonl      每行一条记录，time 是相对开始录制的毫秒数
+//   {dir}/frames/000001.png  截图原图（_screencap 的直接输出）
+// 截图编码和写文件都在单独的写线程里按提交顺序做，不拖慢截图本身
+// 接着往已有目录里录时，time 从上次最后一条记录接着往后算
+// 记录：
+//   { "type": "resolution", "time": 0, "width": 1280, "height": 720 }
+//   { "type": "screencap", "time": 12, "file": "frames/000001.png" }
+//   { "type": "click", "time": 30, "ret": true, "x": 100, "y": 200 }
+//   其余动作同理，字段和对应的 Param 一致
+class SessionRecorder
+{
+public:
+    static constexpr std::string_view kSessionFile = "session.jsonl";
+    // 排着队还没写出去的帧最多这么多，再多就丢掉
+    static constexpr size_t kMaxPendingFrames = 8;
+
+public:
+    // record_frames 为 false 时只记动作
+    SessionRecorder(const std::filesystem::path& dir, bool record_frames = true);
+    ~SessionRecorder();
+
+    bool is_open() const { return ofs_.is_open(); }
+    const std::filesystem::path& dir() const { return dir_; }
+
+    void record_resolution(int width, int height);
+    void record_frame(const cv::Mat& raw, Frame::Clock::time_point capture_time);
+    void record_action(const Action& action, bool ret);
+
+public:
+    static json::object to_json(const Action& action);
+    static std::optional<Action> from_json(const json::value& record);
+
+private:
+    struct Record
+    {
+        json::object line;
+        cv::Mat frame; // 非空时先把它写到 line["file"]，成功了再写这一行
+    };
+
+    int64_t elapsed(Frame::Clock::time_point time) const;
+    int64_t last_recorded_time() const;
+    void post(Record record);
+    bool write(Record record);
+
+    std::filesystem::path dir_;
+    bool record_frames_ = true;
+    Frame::Clock::time_point start_time_;
+    uint64_t frame_count_ = 0;
+
+    std::ofstream ofs_;
+
+    // 帧序号分配和入队在同一把锁里，写线程按队列顺序落盘，jsonl 里的顺序就和帧序号一致
+    std::mutex post_mutex_;
+    std::unique_ptr<AsyncRunner<Record>> writer_ = nullptr;
+    AsyncRunner<Record>::Id last_id_ = MaaInvalidId;
+    std::atomic_size_t pending_frames_ = 0;
+};
+
+MAA_CTRL_NS_END
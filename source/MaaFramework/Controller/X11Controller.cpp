@@ -0,0 +1,460 @@
+#ifdef WITH_X11
+
+#include "X11Controller.h"
+
+#include <atomic>
+#include <thread>
+
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+#include <X11/extensions/XTest.h>
+
+#include <meojson/json.hpp>
+
+#include "Utils/Format.hpp"
+#include "Utils/Logger.h"
+#include "Utils/MatPool.hpp"
+#include "Utils/NoWarningCV.hpp"
+
+MAA_CTRL_NS_BEGIN
+
+struct X11Controller::ShmImage
+{
+    XImage* image = nullptr;
+    XShmSegmentInfo info {};
+};
+
+// Xlib 默认的错误处理会直接退出进程，换成只记下来
+static std::atomic_int x_error_code = 0;
+
+static int on_x_error(Display* display, XErrorEvent* event)
+{
+    std::ignore = display;
+    x_error_code = event->error_code;
+    return 0;
+}
+
+X11Controller::X11Controller(const std::string& display, const std::string& config, MaaControllerCallback callback,
+                             MaaCallbackTransparentArg callback_arg)
+    : ControllerMgr(callback, callback_arg), display_name_(display)
+{
+    LogDebug << VAR(display) << VAR(config);
+
+    if (!config.empty()) {
+        auto config_json = json::parse(config);
+        if (!config_json || !config_json->is_object()) {
+            LogError << "Invalid config: " << config;
+            throw std::runtime_error("MaaX11Controller: Invalid config");
+        }
+
+        if (auto opt = config_json->find("window_id"); opt && opt->is_number()) {
+            window_id_ = static_cast<Window>(opt->as_unsigned_long_long());
+        }
+        window_name_ = config_json->get("window_name", std::string());
+
+        if (auto opt = config_json->find<json::array>("region")) {
+            if (opt->size() != 4 || !std::ranges::all_of(*opt, [](const json::value& v) { return v.is_number(); })) {
+                LogError << "Invalid region: " << *opt;
+                throw std::runtime_error("MaaX11Controller: Invalid region");
+            }
+            region_ = cv::Rect(opt->at(0).as_integer(), opt->at(1).as_integer(), opt->at(2).as_integer(),
+                               opt->at(3).as_integer());
+        }
+    }
+
+    XInitThreads();
+    XSetErrorHandler(&on_x_error);
+}
+
+X11Controller::~X11Controller()
+{
+    destroy_shm_image();
+    if (display_) {
+        XCloseDisplay(display_);
+    }
+}
+
+std::string X11Controller::get_uuid() const
+{
+    return MAA_FMT::format("x11:{}:{:#x}", display_name_, window_);
+}
+
+bool X11Controller::_connect()
+{
+    LogFunc << VAR(display_name_) << VAR(window_id_) << VAR(window_name_);
+
+    destroy_shm_image();
+    if (display_) {
+        XCloseDisplay(display_);
+    }
+
+    display_ = XOpenDisplay(display_name_.empty() ? nullptr : display_name_.c_str());
+    if (!display_) {
+        LogError << "XOpenDisplay failed" << VAR(display_name_);
+        return false;
+    }
+
+    if (!XShmQueryExtension(display_)) {
+        LogError << "MIT-SHM is not supported";
+        return false;
+    }
+    int event_base = 0, error_base = 0, major = 0, minor = 0;
+    if (!XTestQueryExtension(display_, &event_base, &error_base, &major, &minor)) {
+        LogError << "XTest is not supported";
+        return false;
+    }
+
+    Window root = DefaultRootWindow(display_);
+    if (window_id_) {
+        window_ = window_id_;
+    }
+    else if (!window_name_.empty()) {
+        window_ = find_window(root, window_name_);
+    }
+    else {
+        window_ = root;
+    }
+    if (!window_) {
+        LogError << "window not found" << VAR(window_name_);
+        return false;
+    }
+
+    return create_shm_image();
+}
+
+std::pair<int, int> X11Controller::_get_resolution() const
+{
+    return { width_, height_ };
+}
+
+bool X11Controller::_click(ClickParam param)
+{
+    if (!move_pointer(param.x, param.y)) {
+        return false;
+    }
+    XTestFakeButtonEvent(display_, Button1, True, CurrentTime);
+    XTestFakeButtonEvent(display_, Button1, False, CurrentTime);
+    XFlush(display_);
+    return true;
+}
+
+bool X11Controller::_swipe(SwipeParam param)
+{
+    if (!move_pointer(param.x1, param.y1)) {
+        return false;
+    }
+    XTestFakeButtonEvent(display_, Button1, True, CurrentTime);
+    XFlush(display_);
+
+    constexpr int kInterval = 10; // ms
+    const int steps = std::max(param.duration / kInterval, 1);
+    const std::chrono::milliseconds delay(kInterval);
+
+    auto now = std::chrono::steady_clock::now();
+    bool ret = true;
+    for (int i = 1; i <= steps; ++i) {
+        std::this_thread::sleep_until(now + delay);
+        now = std::chrono::steady_clock::now();
+
+        int x = param.x1 + (param.x2 - param.x1) * i / steps;
+        int y = param.y1 + (param.y2 - param.y1) * i / steps;
+        ret &= move_pointer(x, y);
+    }
+
+    XTestFakeButtonEvent(display_, Button1, False, CurrentTime);
+    XFlush(display_);
+    return ret;
+}
+
+bool X11Controller::_touch_down(TouchParam param)
+{
+    // 只有一个鼠标，多点触控做不了
+    if (param.contact != 0) {
+        LogError << "only contact 0 is supported" << VAR(param.contact);
+        return false;
+    }
+    if (!move_pointer(param.x, param.y)) {
+        return false;
+    }
+    XTestFakeButtonEvent(display_, Button1, True, CurrentTime);
+    XFlush(display_);
+    return true;
+}
+
+bool X11Controller::_touch_move(TouchParam param)
+{
+    if (param.contact != 0) {
+        LogError << "only contact 0 is supported" << VAR(param.contact);
+        return false;
+    }
+    return move_pointer(param.x, param.y);
+}
+
+bool X11Controller::_touch_up(TouchParam param)
+{
+    if (param.contact != 0) {
+        LogError << "only contact 0 is supported" << VAR(param.contact);
+        return false;
+    }
+    if (!display_) {
+        LogError << "not connected";
+        return false;
+    }
+    XTestFakeButtonEvent(display_, Button1, False, CurrentTime);
+    XFlush(display_);
+    return true;
+}
+
+bool X11Controller::_press_key(PressKeyParam param)
+{
+    if (!display_) {
+        LogError << "not connected";
+        return false;
+    }
+
+    // keycode 按 X11 的 KeySym 理解，比如回车是 0xff0d
+    KeyCode code = XKeysymToKeycode(display_, static_cast<KeySym>(param.keycode));
+    if (code == 0) {
+        LogError << "no keycode for keysym" << VAR(param.keycode);
+        return false;
+    }
+
+    XTestFakeKeyEvent(display_, code, True, CurrentTime);
+    XTestFakeKeyEvent(display_, code, False, CurrentTime);
+    XFlush(display_);
+    return true;
+}
+
+cv::Mat X11Controller::_screencap()
+{
+    if (!display_ || !shm_) {
+        LogError << "not connected";
+        return {};
+    }
+
+    // 没指定 region 时跟着窗口大小走，窗口变大了 XShmGetImage 不会报错，只会一直截左上角那一块
+    if (region_.area() <= 0) {
+        XWindowAttributes attr {};
+        if (!XGetWindowAttributes(display_, window_, &attr)) {
+            LogError << "XGetWindowAttributes failed" << VAR(window_);
+            return {};
+        }
+        if (attr.width != capture_.width || attr.height != capture_.height) {
+            LogInfo << "window resized, recreate" << VAR(capture_) << VAR(attr.width) << VAR(attr.height);
+            if (!create_shm_image()) {
+                return {};
+            }
+        }
+    }
+
+    x_error_code = 0;
+    if (!XShmGetImage(display_, window_, shm_->image, capture_.x, capture_.y, AllPlanes) || x_error_code) {
+        // 窗口缩到 region 之外了会 BadMatch，重建一次，region 放不下的话 create_shm_image 会报错
+        LogWarn << "XShmGetImage failed, recreate" << VAR(x_error_code.load());
+        if (!create_shm_image()) {
+            return {};
+        }
+        x_error_code = 0;
+        if (!XShmGetImage(display_, window_, shm_->image, capture_.x, capture_.y, AllPlanes) || x_error_code) {
+            LogError << "XShmGetImage failed" << VAR(x_error_code.load());
+            return {};
+        }
+    }
+
+    // 共享内存下一帧就会被覆盖，转换（和缩放）的同时拷进池里的 Mat，整帧只过一遍
+    cv::Mat bgra(shm_->image->height, shm_->image->width, CV_8UC4, shm_->image->data, shm_->image->bytes_per_line);
+    cv::Mat src = bgra;
+    if (target_width_ > 0 && target_height_ > 0 && (target_width_ != bgra.cols || target_height_ != bgra.rows)) {
+        cv::Mat scaled = MatPool::get_instance().acquire(target_height_, target_width_, CV_8UC4);
+        cv::resize(bgra, scaled, { target_width_, target_height_ });
+        src = scaled;
+    }
+
+    cv::Mat dst = MatPool::get_instance().acquire(src.rows, src.cols, CV_8UC3);
+    cv::cvtColor(src, dst, cv::COLOR_BGRA2BGR);
+    return dst;
+}
+
+void X11Controller::_set_screencap_target_size(int width, int height)
+{
+    target_width_ = width;
+    target_height_ = height;
+}
+
+bool X11Controller::_start_app(AppParam param)
+{
+    LogError << "X11 controller does not support start_app" << VAR(param.package);
+    return false;
+}
+
+bool X11Controller::_stop_app(AppParam param)
+{
+    LogError << "X11 controller does not support stop_app" << VAR(param.package);
+    return false;
+}
+
+Window X11Controller::find_window(Window parent, const std::string& name) const
+{
+    char* window_name = nullptr;
+    if (XFetchName(display_, parent, &window_name) && window_name) {
+        bool matched = name == window_name;
+        XFree(window_name);
+        if (matched) {
+            return parent;
+        }
+    }
+
+    Window root_return = 0;
+    Window parent_return = 0;
+    Window* children = nullptr;
+    unsigned int count = 0;
+    if (!XQueryTree(display_, parent, &root_return, &parent_return, &children, &count)) {
+        return 0;
+    }
+
+    Window found = 0;
+    for (unsigned int i = 0; i < count && !found; ++i) {
+        found = find_window(children[i], name);
+    }
+    if (children) {
+        XFree(children);
+    }
+    return found;
+}
+
+bool X11Controller::create_shm_image()
+{
+    LogFunc;
+
+    destroy_shm_image();
+
+    XWindowAttributes attr {};
+    if (!XGetWindowAttributes(display_, window_, &attr)) {
+        LogError << "XGetWindowAttributes failed" << VAR(window_);
+        return false;
+    }
+
+    cv::Rect window_rect(0, 0, attr.width, attr.height);
+    capture_ = region_.area() > 0 ? region_ : window_rect;
+    if ((capture_ & window_rect) != capture_) {
+        LogError << "region out of window" << VAR(capture_) << VAR(attr.width) << VAR(attr.height);
+        return false;
+    }
+
+    if (attr.depth != 24 && attr.depth != 32) {
+        LogError << "unsupported depth" << VAR(attr.depth);
+        return false;
+    }
+
+    shm_ = std::make_unique<ShmImage>();
+    shm_->info.shmid = -1;
+    shm_->image = XShmCreateImage(display_, attr.visual, attr.depth, ZPixmap, nullptr, &shm_->info, capture_.width,
+                                  capture_.height);
+    if (!shm_->image) {
+        LogError << "XShmCreateImage failed";
+        shm_ = nullptr;
+        return false;
+    }
+
+    // 后面直接当 BGRA 用，别的像素格式转出来颜色全是错的
+    const XImage* image = shm_->image;
+    if (image->bits_per_pixel != 32 || image->byte_order != LSBFirst || image->red_mask != 0xff0000
+        || image->green_mask != 0xff00 || image->blue_mask != 0xff) {
+        LogError << "unsupported pixel format" << VAR(image->bits_per_pixel) << VAR(image->byte_order)
+                 << VAR(image->red_mask) << VAR(image->green_mask) << VAR(image->blue_mask);
+        destroy_shm_image();
+        return false;
+    }
+
+    shm_->info.shmid = shmget(IPC_PRIVATE, static_cast<size_t>(shm_->image->bytes_per_line) * shm_->image->height,
+                              IPC_CREAT | 0600);
+    if (shm_->info.shmid < 0) {
+        LogError << "shmget failed";
+        destroy_shm_image();
+        return false;
+    }
+    void* addr = shmat(shm_->info.shmid, nullptr, 0);
+    if (addr == reinterpret_cast<void*>(-1)) {
+        LogError << "shmat failed";
+        destroy_shm_image();
+        return false;
+    }
+    shm_->info.shmaddr = shm_->image->data = static_cast<char*>(addr);
+    shm_->info.readOnly = False;
+
+    x_error_code = 0;
+    if (!XShmAttach(display_, &shm_->info)) {
+        LogError << "XShmAttach failed";
+        destroy_shm_image();
+        return false;
+    }
+    XSync(display_, False);
+    // 双方都 attach 之后就可以标记删除了，进程退出时系统会回收
+    shmctl(shm_->info.shmid, IPC_RMID, nullptr);
+    if (x_error_code) {
+        LogError << "XShmAttach failed" << VAR(x_error_code.load());
+        destroy_shm_image();
+        return false;
+    }
+
+    width_ = capture_.width;
+    height_ = capture_.height;
+    LogInfo << VAR(window_) << VAR(capture_) << VAR(attr.depth);
+    return true;
+}
+
+void X11Controller::destroy_shm_image()
+{
+    if (!shm_) {
+        return;
+    }
+
+    if (shm_->info.shmaddr) {
+        XShmDetach(display_, &shm_->info);
+        shmdt(shm_->info.shmaddr);
+    }
+    if (shm_->info.shmid >= 0) {
+        shmctl(shm_->info.shmid, IPC_RMID, nullptr);
+    }
+    shm_->image->data = nullptr;
+    XDestroyImage(shm_->image);
+    shm_ = nullptr;
+}
+
+std::optional<std::pair<int, int>> X11Controller::to_root(int x, int y) const
+{
+    // 窗口可能被挪过，每次都现算
+    Window child = 0;
+    int root_x = 0;
+    int root_y = 0;
+    if (!XTranslateCoordinates(display_, window_, DefaultRootWindow(display_), capture_.x + x, capture_.y + y, &root_x,
+                               &root_y, &child)) {
+        LogError << "XTranslateCoordinates failed" << VAR(x) << VAR(y);
+        return std::nullopt;
+    }
+    return std::make_pair(root_x, root_y);
+}
+
+bool X11Controller::move_pointer(int x, int y)
+{
+    if (!display_) {
+        LogError << "not connected";
+        return false;
+    }
+
+    auto pos = to_root(x, y);
+    if (!pos) {
+        return false;
+    }
+    XTestFakeMotionEvent(display_, DefaultScreen(display_), pos->first, pos->second, CurrentTime);
+    XFlush(display_);
+    return true;
+}
+
+MAA_CTRL_NS_END
+
+#endif // WITH_X11
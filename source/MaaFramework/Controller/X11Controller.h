@@ -0,0 +1,66 @@
+#pragma once
+
+#ifdef WITH_X11
+
+#include "ControllerMgr.h"
+
+// Xlib 的头里有 None、Bool 之类的宏，不能漏到别的文件里，这里只做前置声明
+struct _XDisplay;
+
+MAA_CTRL_NS_BEGIN
+
+// 直接截 X11 窗口（MIT-SHM），输入走 XTest
+// config: { "window_id": 123, "window_name": "xxx", "region": [x, y, w, h] }，都可以不给，默认整个 root window
+class X11Controller : public ControllerMgr
+{
+public:
+    X11Controller(const std::string& display, const std::string& config, MaaControllerCallback callback,
+                  MaaCallbackTransparentArg callback_arg);
+    virtual ~X11Controller() override;
+
+    virtual std::string get_uuid() const override;
+
+protected:
+    virtual bool _connect() override;
+    virtual std::pair<int, int> _get_resolution() const override;
+    virtual bool _click(ClickParam param) override;
+    virtual bool _swipe(SwipeParam param) override;
+    virtual bool _touch_down(TouchParam param) override;
+    virtual bool _touch_move(TouchParam param) override;
+    virtual bool _touch_up(TouchParam param) override;
+    virtual bool _press_key(PressKeyParam param) override;
+    virtual cv::Mat _screencap() override;
+    virtual void _set_screencap_target_size(int width, int height) override;
+    virtual bool _start_app(AppParam param) override;
+    virtual bool _stop_app(AppParam param) override;
+
+private:
+    using Window = unsigned long; // 就是 X11 的 Window (XID)
+    struct ShmImage;
+
+    Window find_window(Window parent, const std::string& name) const;
+    bool create_shm_image();
+    void destroy_shm_image();
+    std::optional<std::pair<int, int>> to_root(int x, int y) const;
+    bool move_pointer(int x, int y);
+
+    std::string display_name_;
+    Window window_id_ = 0;
+    std::string window_name_;
+    cv::Rect region_; // 配置里给的，没给就是整个窗口
+
+    cv::Rect capture_;
+    _XDisplay* display_ = nullptr;
+    Window window_ = 0;
+    int width_ = 0;
+    int height_ = 0;
+
+    std::unique_ptr<ShmImage> shm_;
+
+    int target_width_ = 0;
+    int target_height_ = 0;
+};
+
+MAA_CTRL_NS_END
+
+#endif // WITH_X11
@@ -288,6 +288,11 @@ bool PipelineResMgr::parse_task(const std::string& name, const json::value& inpu
         return false;
     }
 
+    if (!get_and_check_value(input, "speculative", data.speculative, default_value.speculative)) {
+        LogError << "failed to get_and_check_value speculative" << VAR(input);
+        return false;
+    }
+
     if (!get_and_check_value(input, "focus", data.focus, default_value.focus)) {
         LogError << "failed to get_and_check_value focus" << VAR(input);
         return false;
@@ -140,6 +140,8 @@ struct TaskData
     WaitFreezesParam pre_wait_freezes;
     WaitFreezesParam post_wait_freezes;
 
+    bool speculative = false;
+
     bool focus = false;
 };
 
@@ -10,7 +10,8 @@ MAA_TASK_NS_BEGIN
 
 Actuator::Actuator(InstanceInternalAPI* inst) : inst_(inst) {}
 
-bool Actuator::run(const Recognizer::Result& rec_result, const TaskData& task_data)
+bool Actuator::run(const Recognizer::Result& rec_result, const TaskData& task_data,
+                   const SettledCallback& on_settled)
 {
     using namespace MAA_RES_NS::Action;
     LogFunc << VAR(task_data.name);
@@ -48,6 +49,9 @@ bool Actuator::run(const Recognizer::Result& rec_result, const TaskData& task_da
     }
 
     wait_freezes(task_data.post_wait_freezes, rec_result.box);
+    if (on_settled) {
+        on_settled();
+    }
     sleep(task_data.post_delay);
 
     return true;
@@ -112,12 +116,12 @@ void Actuator::wait_freezes(const MAA_RES_NS::WaitFreezesParam& param, const cv:
         .method = param.method,
     });
 
-    cv::Mat pre_image = controller()->screencap();
+    Frame pre_image = controller()->screencap();
     auto pre_time = std::chrono::steady_clock::now();
 
     while (!need_exit()) {
-        cv::Mat cur_image = controller()->screencap();
-        auto ret = comp.analyze(pre_image, cur_image);
+        Frame cur_image = controller()->screencap();
+        auto ret = comp.analyze(pre_image.image(), cur_image.image());
         if (ret.empty()) {
             pre_image = cur_image;
             pre_time = std::chrono::steady_clock::now();
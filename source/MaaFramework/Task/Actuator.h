@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <stack>
 #include <string_view>
 
@@ -18,11 +19,14 @@ class Actuator : public MaaInstanceSink
 {
 public:
     using TaskData = MAA_RES_NS::TaskData;
+    // 动作执行完且 post_wait_freezes 结束后，post_delay 开始前调用
+    using SettledCallback = std::function<void()>;
 
 public:
     Actuator(InstanceInternalAPI* inst);
 
-    bool run(const Recognizer::Result& rec_result, const TaskData& task_data);
+    bool run(const Recognizer::Result& rec_result, const TaskData& task_data,
+             const SettledCallback& on_settled = nullptr);
 
 public: // from MaaInstanceSink
     virtual void on_stop() override { need_exit_ = true; }
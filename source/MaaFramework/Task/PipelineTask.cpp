@@ -1,6 +1,8 @@
 #include "PipelineTask.h"
 
 #include <sstream>
+#include <thread>
+#include <utility>
 
 #include "Controller/ControllerMgr.h"
 #include "Instance/InstanceStatus.h"
@@ -87,9 +89,18 @@ PipelineTask::RunningResult PipelineTask::find_first_and_run(const std::vector<s
     }
     RecognitionResult result;
 
+    std::optional<RecognitionResult> speculated = std::exchange(speculated_, std::nullopt);
+    if (speculated && speculated_list_ != list) {
+        speculated.reset();
+    }
+    if (speculated) {
+        LogInfo << "Speculative hit:" << speculated->task_data.name;
+        recognizer_.commit_status(speculated->task_data, speculated->rec_result);
+    }
+
     auto start_time = std::chrono::steady_clock::now();
     while (true) {
-        auto find_opt = find_first(list);
+        auto find_opt = speculated ? std::exchange(speculated, std::nullopt) : find_first(list);
         if (find_opt) {
             result = *std::move(find_opt);
             break;
@@ -140,7 +151,29 @@ PipelineTask::RunningResult PipelineTask::find_first_and_run(const std::vector<s
         return RunningResult::Runout;
     }
 
-    auto ret = actuator_.run(result.rec_result, result.task_data);
+    std::atomic_bool speculate_stop = false;
+    std::thread speculate_thread;
+    std::optional<RecognitionResult> speculated_result;
+
+    Actuator::SettledCallback on_settled = nullptr;
+    if (result.task_data.speculative && !result.task_data.next.empty()) {
+        on_settled = [&]() {
+            speculate_thread = std::thread(&PipelineTask::speculate, this, std::cref(result.task_data.next),
+                                           std::cref(speculate_stop), std::ref(speculated_result));
+        };
+    }
+
+    auto ret = actuator_.run(result.rec_result, result.task_data, on_settled);
+
+    speculate_stop = true;
+    if (speculate_thread.joinable()) {
+        speculate_thread.join();
+    }
+    if (ret && speculated_result) {
+        speculated_list_ = result.task_data.next;
+        speculated_ = std::move(speculated_result);
+    }
+
     status()->increase_pipeline_run_times(name);
 
     detail["status"] = "Completed";
@@ -155,7 +188,8 @@ PipelineTask::RunningResult PipelineTask::find_first_and_run(const std::vector<s
     return ret ? RunningResult::Success : RunningResult::Interrupted;
 }
 
-std::optional<PipelineTask::RecognitionResult> PipelineTask::find_first(const std::vector<std::string>& list)
+std::optional<PipelineTask::RecognitionResult> PipelineTask::find_first(const std::vector<std::string>& list,
+                                                                        bool speculative)
 {
     if (!controller()) {
         LogError << "Controller not binded";
@@ -164,7 +198,7 @@ std::optional<PipelineTask::RecognitionResult> PipelineTask::find_first(const st
 
     LogFunc << VAR(cur_task_name_) << VAR(list);
 
-    cv::Mat image = controller()->screencap();
+    Frame frame = controller()->screencap();
 
     for (const std::string& name : list) {
         LogDebug << "recognize:" << name;
@@ -174,7 +208,7 @@ std::optional<PipelineTask::RecognitionResult> PipelineTask::find_first(const st
             continue;
         }
 
-        auto rec_opt = recognizer_.recognize(image, task_data);
+        auto rec_opt = recognizer_.recognize(frame, task_data, speculative);
         if (!rec_opt) {
             continue;
         }
@@ -183,4 +217,21 @@ std::optional<PipelineTask::RecognitionResult> PipelineTask::find_first(const st
     return std::nullopt;
 }
 
+void PipelineTask::speculate(const std::vector<std::string>& list, const std::atomic_bool& stop,
+                             /*out*/ std::optional<RecognitionResult>& newest)
+{
+    LogFunc << VAR(cur_task_name_) << VAR(list);
+
+    using namespace std::chrono_literals;
+    // 截图失败时 find_first 会立刻返回，不限速就是空转
+    constexpr auto kMinInterval = 50ms;
+
+    // 每轮都覆盖结果，只保留最新一帧的识别结果；未命中时也要清空，避免使用过期的命中
+    while (!stop && !need_exit()) {
+        auto round_start = std::chrono::steady_clock::now();
+        newest = find_first(list, true);
+        std::this_thread::sleep_until(round_start + kMinInterval);
+    }
+}
+
 MAA_TASK_NS_END
@@ -13,6 +13,7 @@
 #include "Task/Recognizer.h"
 #include "Task/TaskDataMgr.h"
 
+#include <atomic>
 #include <stack>
 
 MAA_TASK_NS_BEGIN
@@ -58,7 +59,9 @@ private:
 private:
     RunningResult find_first_and_run(const std::vector<std::string>& list, std::chrono::milliseconds find_timeout,
                                      /*out*/ MAA_RES_NS::TaskData& found_data);
-    std::optional<RecognitionResult> find_first(const std::vector<std::string>& list);
+    std::optional<RecognitionResult> find_first(const std::vector<std::string>& list, bool speculative = false);
+    void speculate(const std::vector<std::string>& list, const std::atomic_bool& stop,
+                   /*out*/ std::optional<RecognitionResult>& newest);
 
 private:
     MAA_RES_NS::ResourceMgr* resource() { return inst_ ? inst_->inter_resource() : nullptr; }
@@ -79,6 +82,10 @@ private:
     std::string entry_;
     std::string cur_task_name_;
 
+    // post_delay 期间对 next 的预识别结果，仅由下一次 find_first_and_run 消费
+    std::vector<std::string> speculated_list_;
+    std::optional<RecognitionResult> speculated_;
+
     TaskDataMgr data_mgr_;
     Recognizer recognizer_;
     Actuator actuator_;
@@ -15,7 +15,8 @@ MAA_TASK_NS_BEGIN
 
 Recognizer::Recognizer(InstanceInternalAPI* inst) : inst_(inst) {}
 
-std::optional<Recognizer::Result> Recognizer::recognize(const cv::Mat& image, const TaskData& task_data)
+std::optional<Recognizer::Result> Recognizer::recognize(const Frame& frame, const TaskData& task_data,
+                                                        bool speculative)
 {
     using namespace MAA_RES_NS::Recognition;
     using namespace MAA_VISION_NS;
@@ -36,27 +37,27 @@ std::optional<Recognizer::Result> Recognizer::recognize(const cv::Mat& image, co
         break;
 
     case Type::TemplateMatch:
-        result = template_match(image, std::get<TemplateMatcherParam>(task_data.rec_param), cache, task_data.name);
+        result = template_match(frame, std::get<TemplateMatcherParam>(task_data.rec_param), cache, task_data.name);
         break;
 
     case Type::ColorMatch:
-        result = color_match(image, std::get<ColorMatcherParam>(task_data.rec_param), cache, task_data.name);
+        result = color_match(frame, std::get<ColorMatcherParam>(task_data.rec_param), cache, task_data.name);
         break;
 
     case Type::OCR:
-        result = ocr(image, std::get<OCRerParam>(task_data.rec_param), cache, task_data.name);
+        result = ocr(frame, std::get<OCRerParam>(task_data.rec_param), cache, task_data.name);
         break;
 
     case Type::Classify:
-        result = classify(image, std::get<ClassifierParam>(task_data.rec_param), task_data.name);
+        result = classify(frame, std::get<ClassifierParam>(task_data.rec_param), task_data.name);
         break;
 
     case Type::Detect:
-        result = detect(image, std::get<DetectorParam>(task_data.rec_param), task_data.name);
+        result = detect(frame, std::get<DetectorParam>(task_data.rec_param), task_data.name);
         break;
 
     case Type::Custom:
-        result = custom_recognize(image, std::get<CustomRecognizerParam>(task_data.rec_param), cache, task_data.name);
+        result = custom_recognize(frame, std::get<CustomRecognizerParam>(task_data.rec_param), cache, task_data.name);
         break;
 
     default:
@@ -64,7 +65,7 @@ std::optional<Recognizer::Result> Recognizer::recognize(const cv::Mat& image, co
         return std::nullopt;
     }
 
-    if (result) {
+    if (result && !speculative) {
         status()->set_pipeline_rec_box(task_data.name, result->box);
         status()->set_pipeline_rec_detail(task_data.name, result->detail);
     }
@@ -76,12 +77,22 @@ std::optional<Recognizer::Result> Recognizer::recognize(const cv::Mat& image, co
     return result;
 }
 
+void Recognizer::commit_status(const TaskData& task_data, const Result& result)
+{
+    // inverse 命中时原本就是没识别到，recognize 也不会写
+    if (task_data.inverse || !status()) {
+        return;
+    }
+    status()->set_pipeline_rec_box(task_data.name, result.box);
+    status()->set_pipeline_rec_detail(task_data.name, result.detail);
+}
+
 std::optional<Recognizer::Result> Recognizer::direct_hit()
 {
     return Result { .box = cv::Rect(), .detail = json::array() };
 }
 
-std::optional<Recognizer::Result> Recognizer::template_match(const cv::Mat& image,
+std::optional<Recognizer::Result> Recognizer::template_match(const Frame& frame,
                                                              const MAA_VISION_NS::TemplateMatcherParam& param,
                                                              const cv::Rect& cache, const std::string& name)
 {
@@ -93,7 +104,7 @@ std::optional<Recognizer::Result> Recognizer::template_match(const cv::Mat& imag
     }
 
     Matcher matcher;
-    matcher.set_image(image);
+    matcher.set_image(frame);
     matcher.set_name(name);
     matcher.set_param(param);
     matcher.set_cache(cache);
@@ -122,7 +133,7 @@ std::optional<Recognizer::Result> Recognizer::template_match(const cv::Mat& imag
     return Result { .box = box, .detail = detail.to_string() };
 }
 
-std::optional<Recognizer::Result> Recognizer::color_match(const cv::Mat& image,
+std::optional<Recognizer::Result> Recognizer::color_match(const Frame& frame,
                                                           const MAA_VISION_NS::ColorMatcherParam& param,
                                                           const cv::Rect& cache, const std::string& name)
 {
@@ -134,7 +145,7 @@ std::optional<Recognizer::Result> Recognizer::color_match(const cv::Mat& image,
     }
 
     ColorMatcher matcher;
-    matcher.set_image(image);
+    matcher.set_image(frame);
     matcher.set_name(name);
     matcher.set_param(param);
     matcher.set_cache(cache);
@@ -152,7 +163,7 @@ std::optional<Recognizer::Result> Recognizer::color_match(const cv::Mat& image,
     return Result { .box = box, .detail = detail.to_string() };
 }
 
-std::optional<Recognizer::Result> Recognizer::ocr(const cv::Mat& image, const MAA_VISION_NS::OCRerParam& param,
+std::optional<Recognizer::Result> Recognizer::ocr(const Frame& frame, const MAA_VISION_NS::OCRerParam& param,
                                                   const cv::Rect& cache, const std::string& name)
 {
     using namespace MAA_VISION_NS;
@@ -163,7 +174,7 @@ std::optional<Recognizer::Result> Recognizer::ocr(const cv::Mat& image, const MA
     }
 
     OCRer ocrer;
-    ocrer.set_image(image);
+    ocrer.set_image(frame);
     ocrer.set_name(name);
     ocrer.set_param(param);
     ocrer.set_cache(cache);
@@ -189,7 +200,7 @@ std::optional<Recognizer::Result> Recognizer::ocr(const cv::Mat& image, const MA
     return Result { .box = box, .detail = std::move(detail) };
 }
 
-std::optional<Recognizer::Result> Recognizer::classify(const cv::Mat& image,
+std::optional<Recognizer::Result> Recognizer::classify(const Frame& frame,
                                                        const MAA_VISION_NS::ClassifierParam& param,
                                                        const std::string& name)
 {
@@ -201,7 +212,7 @@ std::optional<Recognizer::Result> Recognizer::classify(const cv::Mat& image,
     }
 
     Classifier classifier;
-    classifier.set_image(image);
+    classifier.set_image(frame);
     classifier.set_name(name);
     classifier.set_param(param);
 
@@ -221,7 +232,7 @@ std::optional<Recognizer::Result> Recognizer::classify(const cv::Mat& image,
     return Result { .box = box, .detail = std::move(detail) };
 }
 
-std::optional<Recognizer::Result> Recognizer::detect(const cv::Mat& image, const MAA_VISION_NS::DetectorParam& param,
+std::optional<Recognizer::Result> Recognizer::detect(const Frame& frame, const MAA_VISION_NS::DetectorParam& param,
                                                      const std::string& name)
 {
     using namespace MAA_VISION_NS;
@@ -232,7 +243,7 @@ std::optional<Recognizer::Result> Recognizer::detect(const cv::Mat& image, const
     }
 
     Detector detector;
-    detector.set_image(image);
+    detector.set_image(frame);
     detector.set_name(name);
     detector.set_param(param);
 
@@ -252,7 +263,7 @@ std::optional<Recognizer::Result> Recognizer::detect(const cv::Mat& image, const
     return Result { .box = box, .detail = std::move(detail) };
 }
 
-std::optional<Recognizer::Result> Recognizer::custom_recognize(const cv::Mat& image,
+std::optional<Recognizer::Result> Recognizer::custom_recognize(const Frame& frame,
                                                                const MAA_VISION_NS::CustomRecognizerParam& param,
                                                                const cv::Rect& cache, const std::string& name)
 {
@@ -270,7 +281,7 @@ std::optional<Recognizer::Result> Recognizer::custom_recognize(const cv::Mat& im
         LogError << "Custom recognizer not found:" << param.name;
         return std::nullopt;
     }
-    recognizer->set_image(image);
+    recognizer->set_image(frame);
     recognizer->set_param(param);
     recognizer->set_name(name);
 
@@ -5,6 +5,7 @@
 #include <meojson/json.hpp>
 
 #include "API/MaaTypes.h"
+#include "Base/Frame.h"
 #include "Conf/Conf.h"
 #include "Instance/InstanceInternalAPI.hpp"
 #include "Resource/PipelineResMgr.h"
@@ -29,21 +30,23 @@ public:
     Recognizer(InstanceInternalAPI* inst);
 
 public:
-    std::optional<Result> recognize(const cv::Mat& image, const TaskData& task_data);
+    // speculative 时不写 status，结果真被用上了再 commit_status
+    std::optional<Result> recognize(const Frame& frame, const TaskData& task_data, bool speculative = false);
+    void commit_status(const TaskData& task_data, const Result& result);
 
 private:
     std::optional<Result> direct_hit();
-    std::optional<Result> template_match(const cv::Mat& image, const MAA_VISION_NS::TemplateMatcherParam& param,
+    std::optional<Result> template_match(const Frame& frame, const MAA_VISION_NS::TemplateMatcherParam& param,
                                          const cv::Rect& cache, const std::string& name);
-    std::optional<Result> color_match(const cv::Mat& image, const MAA_VISION_NS::ColorMatcherParam& param,
+    std::optional<Result> color_match(const Frame& frame, const MAA_VISION_NS::ColorMatcherParam& param,
                                       const cv::Rect& cache, const std::string& name);
-    std::optional<Result> ocr(const cv::Mat& image, const MAA_VISION_NS::OCRerParam& param, const cv::Rect& cache,
+    std::optional<Result> ocr(const Frame& frame, const MAA_VISION_NS::OCRerParam& param, const cv::Rect& cache,
                               const std::string& name);
-    std::optional<Result> classify(const cv::Mat& image, const MAA_VISION_NS::ClassifierParam& param,
+    std::optional<Result> classify(const Frame& frame, const MAA_VISION_NS::ClassifierParam& param,
                                    const std::string& name);
-    std::optional<Result> detect(const cv::Mat& image, const MAA_VISION_NS::DetectorParam& param,
+    std::optional<Result> detect(const Frame& frame, const MAA_VISION_NS::DetectorParam& param,
                                  const std::string& name);
-    std::optional<Result> custom_recognize(const cv::Mat& image, const MAA_VISION_NS::CustomRecognizerParam& param,
+    std::optional<Result> custom_recognize(const Frame& frame, const MAA_VISION_NS::CustomRecognizerParam& param,
                                            const cv::Rect& cache, const std::string& name);
 
 private:
@@ -57,7 +57,7 @@ bool SyncContext::run_recognizer(cv::Mat image, std::string task, std::string_vi
     data_mgr.set_param(*json_opt);
     const auto& task_data = data_mgr.get_task_data(task);
 
-    auto opt = recognizer.recognize(image, task_data);
+    auto opt = recognizer.recognize(Frame(std::move(image)), task_data);
     if (!opt) {
         return false;
     }
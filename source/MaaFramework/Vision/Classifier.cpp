@@ -65,13 +65,14 @@ Classifier::Result Classifier::classify(const cv::Rect& roi) const
         return {};
     }
 
-    cv::Mat image = image_with_roi(roi);
-    std::vector<float> input = image_to_tensor(image);
+    std::vector<float> input = tensor_with_roi(roi);
+    cv::Size size = correct_roi(roi, image_).size();
 
     // TODO: GPU
     auto memory_info = Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU);
     constexpr int64_t kBatchSize = 1;
-    std::array<int64_t, 4> input_shape { kBatchSize, image.channels(), image.cols, image.rows };
+    constexpr int64_t kChannels = 3; // tensor_with_roi 出来的是 RGB
+    std::array<int64_t, 4> input_shape { kBatchSize, kChannels, size.width, size.height };
 
     Ort::Value input_tensor = Ort::Value::CreateTensor<float>(memory_info, input.data(), input.size(),
                                                               input_shape.data(), input_shape.size());
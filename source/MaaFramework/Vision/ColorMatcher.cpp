@@ -57,9 +57,7 @@ ColorMatcher::ResultsVec ColorMatcher::foreach_rois(const ColorMatcherParam::Ran
 ColorMatcher::Result ColorMatcher::color_match(const cv::Rect& roi, const ColorMatcherParam::Range& range,
                                                bool connected) const
 {
-    cv::Mat image = image_with_roi(roi);
-    cv::Mat color;
-    cv::cvtColor(image, color, param_.method);
+    cv::Mat color = cvt_color_with_roi(param_.method, roi);
     cv::Mat bin;
     cv::inRange(color, range.first, range.second, bin);
 
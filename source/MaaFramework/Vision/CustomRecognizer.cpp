@@ -27,7 +27,8 @@ CustomRecognizer::ResultsVec CustomRecognizer::analyze() const
     /*in*/
     MAA_TASK_NS::SyncContext sync_ctx(inst_);
     ImageBuffer image_buffer;
-    image_buffer.set(image_);
+    // 自定义识别器只读这张图，没必要再拷一份
+    image_buffer.share(image_);
     std::string custom_param_str = param_.custom_param.to_string();
 
     /*out*/
@@ -11,9 +11,10 @@
 
 MAA_VISION_NS_BEGIN
 
-void VisionBase::set_image(const cv::Mat& image)
+void VisionBase::set_image(const Frame& frame)
 {
-    image_ = image;
+    frame_ = frame;
+    image_ = frame.image();
     init_debug_draw();
 }
 
@@ -33,6 +34,22 @@ cv::Mat VisionBase::image_with_roi(const cv::Rect& roi) const
     return image_(roi_corrected);
 }
 
+cv::Mat VisionBase::cvt_color_with_roi(int code, const cv::Rect& roi) const
+{
+    // 只转 roi 这一块，ColorMatch 的 roi 一般很小，转整帧反而更慢
+    return frame_.cvt_color(code, correct_roi(roi, image_));
+}
+
+std::vector<float> VisionBase::tensor_with_roi(const cv::Rect& roi) const
+{
+    // 整帧转成 float 要十几 MB，模型的 roi 一般只占一小块，不缓存整帧
+    cv::Mat rgb;
+    cv::cvtColor(image_with_roi(roi), rgb, cv::COLOR_BGR2RGB);
+    cv::Mat rgb_float;
+    rgb.convertTo(rgb_float, CV_32F, 1.0 / 255.0);
+    return rgb_float_to_tensor(rgb_float);
+}
+
 cv::Mat VisionBase::draw_roi(const cv::Rect& roi) const
 {
     cv::Mat image_draw = image_.clone();
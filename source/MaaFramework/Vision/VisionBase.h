@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Base/Frame.h"
 #include "Conf/Conf.h"
 #include "Utils/NoWarningCVMat.hpp"
 
@@ -8,18 +9,23 @@ MAA_VISION_NS_BEGIN
 class VisionBase
 {
 public:
-    void set_image(const cv::Mat& image);
+    void set_image(const Frame& frame);
     void set_cache(const cv::Rect& cache);
     void set_name(std::string name);
 
 protected:
     cv::Mat image_with_roi(const cv::Rect& roi) const;
+    // 整帧转换结果缓存在 frame_ 上，同一帧的其他识别器可以直接复用
+    cv::Mat cvt_color_with_roi(int code, const cv::Rect& roi) const;
+    // 模型输入，只转 roi 部分
+    std::vector<float> tensor_with_roi(const cv::Rect& roi) const;
 
 protected:
     cv::Mat draw_roi(const cv::Rect& roi) const;
     void save_image(const cv::Mat& image) const;
 
 protected:
+    Frame frame_;
     cv::Mat image_ {};
     cv::Rect cache_ {};
     std::string name_;
@@ -121,16 +121,12 @@ inline static cv::Mat hwc_to_chw(const cv::Mat& src)
     return flat_image;
 }
 
-inline static std::vector<float> image_to_tensor(const cv::Mat& image)
+// rgb_float: RGB, CV_32FC3, 已归一化到 [0, 1]
+inline static std::vector<float> rgb_float_to_tensor(const cv::Mat& rgb_float)
 {
-    cv::Mat src = image.clone();
-    cv::cvtColor(src, src, cv::COLOR_BGR2RGB);
+    cv::Mat chw_32f = hwc_to_chw(rgb_float);
 
-    cv::Mat chw = hwc_to_chw(src);
-    cv::Mat chw_32f;
-    chw.convertTo(chw_32f, CV_32F, 1.0 / 255.0);
-
-    size_t tensor_size = 1ULL * src.cols * src.rows * src.channels();
+    size_t tensor_size = 1ULL * rgb_float.cols * rgb_float.rows * rgb_float.channels();
     std::vector<float> tensor(tensor_size);
     std::memcpy(tensor.data(), chw_32f.data, tensor_size * sizeof(float));
     return tensor;
@@ -36,6 +36,11 @@ inline static const json::value kAdbConfig = R"(
         "maatouch": {
             "root": "./MaaAgentBinary/maatouch",
             "package": "com.shxyke.MaaTouch.App"
+        },
+        "scrcpy": {
+            "root": "./MaaAgentBinary/scrcpy",
+            "version": "2.1.1",
+            "options": "max_fps=60"
         }
     },
     "command": {
@@ -188,6 +193,13 @@ inline static const json::value kAdbConfig = R"(
             "shell",
             "chmod 700 \"/data/local/tmp/{BIN_WORKING_FILE}\""
         ],
+        "CheckBin": [
+            "{ADB}",
+            "-s",
+            "{ADB_SERIAL}",
+            "shell",
+            "stat -c %s \"/data/local/tmp/{BIN_WORKING_FILE}\""
+        ],
         "InvokeBin": [
             "{ADB}",
             "-s",
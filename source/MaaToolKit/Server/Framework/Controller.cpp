@@ -48,6 +48,11 @@ auto cfg = R"({
         "maatouch": {
             "root": "./MaaAgentBinary/maatouch",
             "package": "com.shxyke.MaaTouch.App"
+        },
+        "scrcpy": {
+            "root": "./MaaAgentBinary/scrcpy",
+            "version": "2.1.1",
+            "options": "max_fps=60"
         }
     },
     "command": {
@@ -196,6 +201,13 @@ auto cfg = R"({
             "shell",
             "chmod 700 \"/data/local/tmp/{BIN_WORKING_FILE}\""
         ],
+        "CheckBin": [
+            "{ADB}",
+            "-s",
+            "{ADB_SERIAL}",
+            "shell",
+            "stat -c %s \"/data/local/tmp/{BIN_WORKING_FILE}\""
+        ],
         "InvokeBin": [
             "{ADB}",
             "-s",
@@ -252,6 +264,8 @@ void init_maa_framework_controller(ApiDispatcher& disp)
                     { "touch.maatouch", MaaAdbControllerType_Touch_MaaTouch },
                     { "key.adb", MaaAdbControllerType_Key_Adb },
                     { "key.maatouch", MaaAdbControllerType_Key_MaaTouch },
+                    { "touch.scrcpy", MaaAdbControllerType_Touch_Scrcpy },
+                    { "key.scrcpy", MaaAdbControllerType_Key_Scrcpy },
                     { "screencap.fastest", MaaAdbControllerType_Screencap_FastestWay },
                     { "screencap.rawbynetcat", MaaAdbControllerType_Screencap_RawByNetcat },
                     { "screencap.rawwithgzip", MaaAdbControllerType_Screencap_RawWithGzip },
@@ -259,6 +273,8 @@ void init_maa_framework_controller(ApiDispatcher& disp)
                     { "screencap.encodetofile", MaaAdbControllerType_Screencap_EncodeToFile },
                     { "screencap.minicapdirect", MaaAdbControllerType_Screencap_MinicapDirect },
                     { "screencap.minicapstream", MaaAdbControllerType_Screencap_MinicapStream },
+                    { "screencap.tilestream", MaaAdbControllerType_Screencap_TileStream },
+                    { "screencap.scrcpy", MaaAdbControllerType_Screencap_Scrcpy },
                 };
 
                 auto adb = require_key_as_string(obj, "adb");
@@ -1,7 +1,13 @@
 #pragma once
 
+#include <algorithm>
+#include <chrono>
+#include <functional>
 #include <memory>
 #include <optional>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "Conf/Conf.h"
 #include "MaaFramework/MaaDef.h"
@@ -51,6 +57,37 @@ public:
 
 /* Input */
 
+struct TouchEvent
+{
+    enum class Type
+    {
+        Down,
+        Move,
+        Up,
+    } type = Type::Move;
+
+    int contact = 0;
+    int x = 0;
+    int y = 0;
+    int pressure = 0;
+    int time = 0; // 相对手势开始的毫秒数
+};
+
+// 按 time 依次把事件交给 run，全部成功才返回 true
+// 只能一个个点去调的输入方式（TouchInputBase 和框架里的默认实现）都走这里
+inline bool play_touch_events(std::vector<TouchEvent> events, const std::function<bool(const TouchEvent&)>& run)
+{
+    std::ranges::stable_sort(events, {}, &TouchEvent::time);
+
+    auto start = std::chrono::steady_clock::now();
+    bool ret = true;
+    for (const auto& event : events) {
+        std::this_thread::sleep_until(start + std::chrono::milliseconds(event.time));
+        ret &= run(event);
+    }
+    return ret;
+}
+
 class TouchInputAPI
 {
 public:
@@ -66,6 +103,9 @@ public:
     virtual bool touch_down(int contact, int x, int y, int pressure) = 0;
     virtual bool touch_move(int contact, int x, int y, int pressure) = 0;
     virtual bool touch_up(int contact) = 0;
+
+    // 一整段多点触控，按 time 执行完才返回
+    virtual bool gesture(const std::vector<TouchEvent>& events) = 0;
 };
 
 class KeyInputAPI
@@ -78,6 +118,18 @@ public:
 
 /* Screencap */
 
+struct ScreencapMethodStats
+{
+    std::string method;
+    size_t success = 0;
+    size_t failure = 0;
+    size_t consecutive_failure = 0;
+    // 最近若干次成功的耗时，毫秒；还没有成功过的是 -1
+    int64_t median = -1;
+    int64_t p90 = -1;
+    int64_t baseline = -1; // 测速或者切换过来时的中位数
+};
+
 class ScreencapAPI
 {
 public:
@@ -86,8 +138,20 @@ public:
     virtual bool init(int swidth, int sheight) = 0;
     virtual void deinit() = 0;
     virtual void set_wh(int swidth, int sheight) = 0;
+    // 调用方最终要的图像大小，能顺便缩放的截图方式可以直接输出这个大小；0 表示不缩放
+    virtual void set_target_size(int width, int height) = 0;
+
+    // 截图方式从快到慢的排名，可以缓存下来，下次连同一台设备时先 set 进来，init 就只验证第一名而不完整测速
+    virtual void set_preferred_methods(std::vector<std::string> methods) = 0;
+    virtual std::vector<std::string> get_preferred_methods() const = 0;
+
+    // 当前用的截图方式和各方式的统计，只有一种方式的返回空
+    virtual std::string get_current_method() const = 0;
+    virtual std::vector<ScreencapMethodStats> get_method_stats() const = 0;
 
     virtual std::optional<cv::Mat> screencap() = 0;
+    // 最近一次 screencap 相对再上一次变了的区域，坐标在 screencap 返回的图上；nullopt 表示不知道，当作整张都变了
+    virtual std::optional<std::vector<cv::Rect>> changed_regions() const = 0;
 };
 
 /* Main */
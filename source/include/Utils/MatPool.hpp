@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+#include "Conf/Conf.h"
+#include "NoWarningCVMat.hpp"
+#include "SingletonHolder.hpp"
+
+MAA_NS_BEGIN
+
+// 截图链路（读取 -> 解码 -> 转换 -> 缩放）用的 Mat 缓冲池，按 尺寸 + 类型 复用
+// 池子本身持有一份引用，引用计数回到 1 说明外面已经没人用了，可以再次借出
+class MatPool : public SingletonHolder<MatPool>
+{
+public:
+    friend class SingletonHolder<MatPool>;
+
+    inline static constexpr size_t kMaxPerKey = 4;
+    inline static constexpr size_t kMaxKeys = 8;
+
+public:
+    virtual ~MatPool() = default;
+
+    // 返回的 Mat 内容未初始化
+    cv::Mat acquire(int rows, int cols, int type)
+    {
+        if (rows <= 0 || cols <= 0) {
+            return {};
+        }
+
+        std::unique_lock lock { mutex_ };
+
+        auto key = std::make_tuple(rows, cols, type);
+        auto& bucket = buckets_[key];
+        bucket.last_used = ++tick_;
+
+        for (const cv::Mat& mat : bucket.mats) {
+            if (mat.u && mat.u->refcount == 1) {
+                return mat;
+            }
+        }
+
+        cv::Mat mat(rows, cols, type);
+        if (bucket.mats.size() < kMaxPerKey) {
+            bucket.mats.emplace_back(mat);
+        }
+        shrink();
+        return mat;
+    }
+
+    cv::Mat acquire(cv::Size size, int type) { return acquire(size.height, size.width, type); }
+
+    void clear()
+    {
+        std::unique_lock lock { mutex_ };
+        buckets_.clear();
+    }
+
+private:
+    MatPool() = default;
+
+    // 分辨率/类型变了之后旧的桶就不会再被用到，只保留最近用过的几种
+    void shrink()
+    {
+        while (buckets_.size() > kMaxKeys) {
+            auto oldest = buckets_.begin();
+            for (auto it = buckets_.begin(); it != buckets_.end(); ++it) {
+                if (it->second.last_used < oldest->second.last_used) {
+                    oldest = it;
+                }
+            }
+            buckets_.erase(oldest);
+        }
+    }
+
+private:
+    struct Bucket
+    {
+        std::vector<cv::Mat> mats;
+        uint64_t last_used = 0;
+    };
+
+    std::mutex mutex_;
+    std::map<std::tuple<int, int, int>, Bucket> buckets_;
+    uint64_t tick_ = 0;
+};
+
+MAA_NS_END